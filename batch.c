@@ -0,0 +1,546 @@
+/**
+ * @file batch.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Multithreaded batch solving of puzzle arrays, parallel search of single puzzles
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./bitboard.h"
+#include "./batch.h"
+#include "./canon.h"
+#include "./ui.h"
+
+
+/// @brief Work shared by all workers of one runBatchTasks() call
+typedef struct BatchJob {
+    /// @brief Called for every item
+    BatchTask task;
+    /// @brief Passed to task
+    void *context;
+    /// @brief Number of items
+    int itemCount;
+    /// @brief Items claimed per fetch
+    int chunkSize;
+    /// @brief Index of the next unclaimed item
+    atomic_int next;
+    /// @brief Sum of the task results so far
+    atomic_long total;
+} BatchJob;
+
+
+/// @brief Context of the solvePuzzleBatch() task
+typedef struct SolveBatch {
+    /// @brief Array being solved
+    PuzzleArray puzzleArray;
+    /// @brief Per-puzzle results, can be NULL
+    BatchStatus *statuses;
+    /// @brief Per-puzzle wall-clock solve times, negative for puzzles not solved
+    double *seconds;
+} SolveBatch;
+
+
+/// @brief Shared state of one solveSudokuParallel() call
+typedef struct ParallelSearch {
+    /// @brief Guards tasks, taskCount and done
+    pthread_mutex_t lock;
+    /// @brief Signalled when tasks are added or the search ends
+    pthread_cond_t wake;
+    /// @brief Unexplored subtrees, used as a stack
+    PropagationState *tasks;
+    /// @brief Number of subtrees in tasks
+    int taskCount;
+    /// @brief Number of workers
+    int threadCount;
+    /// @brief Workers waiting for a subtree, read without the lock to decide when to share work
+    atomic_int idle;
+    /// @brief Set once a solution is found, makes every worker stop
+    atomic_int cancelled;
+    /// @brief Set once every worker is idle and no subtrees are left
+    int done;
+    /// @brief First solution found
+    PropagationState solution;
+#ifdef SOLVER_INSTRUMENTATION
+    /// @brief Work of every worker, guarded by lock and added to the caller's solverStats at the end
+    SolverStats stats;
+#endif
+} ParallelSearch;
+
+
+/// @brief Finds the number of online CPU cores
+/// @return Core count, at least 1
+int findCoreCount() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) {
+        return 1;
+    }
+    if (cores > MAX_WORKER_THREADS) {
+        return MAX_WORKER_THREADS;
+    }
+    return (int)cores;
+}
+
+
+/// @brief Builds the lookup tables of every solver engine
+/// @note Must be called before solving from several threads, as tables are built lazily
+void prepareSolversForThreads() {
+    initSolverTables();
+    initBitboardMasks();
+}
+
+
+/// @brief Worker thread: claims chunks of items until none are left
+/// @param arg BatchJob being worked on
+/// @return NULL
+/// @details Chunks are claimed from a shared atomic counter, so a worker that got easy
+/// \ puzzles simply claims more instead of sitting idle
+static void *batchWorker(void *arg) {
+    BatchJob *job = arg;
+    long total = 0;
+
+    while (1) {
+        int start = atomic_fetch_add(&job->next, job->chunkSize);
+        if (start >= job->itemCount) {
+            break;
+        }
+        int end = start + job->chunkSize;
+        if (end > job->itemCount) {
+            end = job->itemCount;
+        }
+
+        for (int i = start; i < end; ++i) {
+            total += job->task(i, job->context);
+        }
+    }
+
+    atomic_fetch_add(&job->total, total);
+    return NULL;
+}
+
+
+/// @brief Runs a task for every item index using a pool of worker threads
+/// @param itemCount Number of items, indices 0 to itemCount - 1
+/// @param task Called once per index, from any worker
+/// @param context Passed to task
+/// @param threadCount Number of workers; 0 or less uses every core
+/// @return Sum of the task results
+/// @note The calling thread works too; solver tables are built before workers start
+long runBatchTasks(int itemCount, BatchTask task, void *context, int threadCount) {
+    pthread_t threads[MAX_WORKER_THREADS];
+    BatchJob job;
+
+    if (threadCount <= 0 || threadCount > MAX_WORKER_THREADS) {
+        threadCount = findCoreCount();
+    }
+    if (threadCount > itemCount) {
+        threadCount = itemCount > 0 ? itemCount : 1;
+    }
+
+    job.task = task;
+    job.context = context;
+    job.itemCount = itemCount;
+    // small chunks keep cores busy at the end of the array, big chunks keep the counter cold
+    job.chunkSize = itemCount / (threadCount * 16);
+    if (job.chunkSize < 1) {
+        job.chunkSize = 1;
+    }
+    if (job.chunkSize > BATCH_MAX_CHUNK) {
+        job.chunkSize = BATCH_MAX_CHUNK;
+    }
+    atomic_init(&job.next, 0);
+    atomic_init(&job.total, 0);
+
+    prepareSolversForThreads();
+
+    int started = 0;
+    for (int t = 1; t < threadCount; ++t) {
+        if (pthread_create(&threads[started], NULL, batchWorker, &job) != 0) {
+            break;
+        }
+        started++;
+    }
+    batchWorker(&job);  // calling thread works too
+    for (int t = 0; t < started; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    return atomic_load(&job.total);
+}
+
+
+/// @brief Solves one batch puzzle with the selected engine on the calling thread
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+static int solveOnThisThread(Puzzle *puzzle) {
+    // puzzles are already spread over every core, so search each one on this thread
+    if (solverEngine != SOLVER_ENGINE_PARALLEL) {
+        return solveSudokuUncached(puzzle, 0, 0);
+    }
+    STAT_BEGIN();
+    int result = solveSudokuPropagation(puzzle);
+    STAT_END();
+    return result;
+}
+
+
+/// @brief Finds elapsed wall-clock time of one solve, see solveSudokuUserGrid()
+/// @return Seconds since an arbitrary point
+static double wallTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/// @brief Task of solvePuzzleBatch(): solves one puzzle
+/// @return 1: solved; 0: unsolvable
+static int solveBatchPuzzle(int index, void *context) {
+    SolveBatch *batch = context;
+    Puzzle *puzzle = puzzleAt(batch->puzzleArray, index);
+    double start = wallTime();
+    int result = solutionCacheEnabled ? solveSudokuCached(puzzle, solveOnThisThread) : solveOnThisThread(puzzle);
+    batch->seconds[index] = result ? wallTime() - start : -1.0;
+    if (result) {
+        rebuildPlayTracker(puzzle);
+    }
+    if (batch->statuses != NULL) {
+        batch->statuses[index] = result ? BATCH_STATUS_SOLVED : BATCH_STATUS_UNSOLVABLE;
+    }
+    return result;
+}
+
+
+/// @brief Solves every puzzle of an array in place using a pool of worker threads
+/// @param puzzleArray Array to solve, user grids are overwritten with solutions; NULL in lazy mode
+/// @param puzzleCount Array size
+/// @param statuses Receives result of each puzzle, can be NULL
+/// @param threadCount Number of workers; 0 or less uses every core
+/// @return Number of puzzles solved
+/// @details Uses the engine selected in #solverEngine
+int solvePuzzleBatch(PuzzleArray puzzleArray, int puzzleCount, BatchStatus *statuses, int threadCount) {
+    SolveBatch batch = {puzzleArray, statuses, malloc((puzzleCount > 0 ? puzzleCount : 1) * sizeof(double))};
+    if (batch.seconds == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    if (statuses != NULL) {
+        for (int i = 0; i < puzzleCount; ++i) {
+            statuses[i] = BATCH_STATUS_PENDING;
+        }
+    }
+
+    int solved = (int)runBatchTasks(puzzleCount, solveBatchPuzzle, &batch, threadCount);
+
+    // metadata feeds the shared puzzle index, so it is updated here rather than by the workers
+    for (int i = 0; i < puzzleCount; ++i) {
+        if (batch.seconds[i] >= 0) {
+            recordSolveTime(puzzleAt(puzzleArray, i), batch.seconds[i]);
+        }
+        else {
+            refreshPuzzleMeta(puzzleAt(puzzleArray, i));
+        }
+    }
+    free(batch.seconds);
+
+    return solved;
+}
+
+
+/// @brief Context of generatePuzzleBatch() tasks
+typedef struct GenerateBatch {
+    /// @brief Puzzles being generated
+    Puzzle *puzzles;
+    /// @brief Clues per puzzle, the most allowed if minimal
+    int clues;
+    /// @brief 1: minimal puzzles
+    int minimal;
+    /// @brief Master seed every stream is derived from
+    unsigned long long seed;
+    /// @brief Stream number of the first puzzle
+    long firstIndex;
+} GenerateBatch;
+
+
+/// @brief Task of generatePuzzleBatch(): generates one puzzle from its own stream
+/// @return 1
+static int generateBatchPuzzle(int index, void *context) {
+    GenerateBatch *batch = context;
+    RandomStream random;
+    seedRandomStream(&random, batch->seed, (unsigned long long)(batch->firstIndex + index));
+    memset(&batch->puzzles[index], 0, sizeof(Puzzle));
+    generateUniquePuzzle(&batch->puzzles[index], batch->clues, batch->minimal, &random);
+    return 1;
+}
+
+
+/// @brief Generates puzzles with unique solutions on every worker
+/// @param puzzles Array of count puzzles to fill
+/// @param count Puzzles to generate
+/// @param clues Clues per puzzle; with minimal, the most clues allowed
+/// @param minimal 1: every clue of every puzzle is needed
+/// @param seed Master seed
+/// @param firstIndex Number of puzzles generated from this seed before, so output can be made in batches
+/// @param threadCount Number of workers; 0 or less uses every core
+/// @return Puzzles generated
+/// @details Puzzle n is drawn from stream n of the master seed, which the worker seeds locally.
+/// \ Workers share no random state, and the output depends only on seed and position, not on the
+/// \ number of workers or which worker took which puzzle.
+long generatePuzzleBatch(Puzzle *puzzles, int count, int clues, int minimal, unsigned long long seed, \
+    long firstIndex, int threadCount) {
+    GenerateBatch batch = {puzzles, clues, minimal, seed, firstIndex};
+    return runBatchTasks(count, generateBatchPuzzle, &batch, threadCount);
+}
+
+
+/// @brief Adds a subtree to the shared stack
+/// @param search Search to add to
+/// @param state Subtree root
+/// @return 1: added; 0: stack is full, caller should explore it itself
+static int pushTask(ParallelSearch *search, const PropagationState *state) {
+    int pushed = 0;
+    pthread_mutex_lock(&search->lock);
+    if (search->taskCount < PARALLEL_MAX_TASKS) {
+        search->tasks[search->taskCount++] = *state;
+        pushed = 1;
+        pthread_cond_signal(&search->wake);
+    }
+    pthread_mutex_unlock(&search->lock);
+    return pushed;
+}
+
+
+/// @brief Takes a subtree from the shared stack, waiting while other workers may still add some
+/// @param search Search to take from
+/// @param state Receives the subtree root
+/// @return 1: got a subtree; 0: search is over
+static int popTask(ParallelSearch *search, PropagationState *state) {
+    int got = 0;
+    pthread_mutex_lock(&search->lock);
+    atomic_fetch_add(&search->idle, 1);
+    while (search->taskCount == 0 && !search->done && !atomic_load(&search->cancelled)) {
+        if (atomic_load(&search->idle) == search->threadCount) {
+            search->done = 1;  // nobody is left to add work
+            pthread_cond_broadcast(&search->wake);
+            break;
+        }
+        pthread_cond_wait(&search->wake, &search->lock);
+    }
+    if (search->taskCount > 0 && !search->done && !atomic_load(&search->cancelled)) {
+        *state = search->tasks[--search->taskCount];
+        atomic_fetch_sub(&search->idle, 1);
+        got = 1;
+    }
+    pthread_mutex_unlock(&search->lock);
+    return got;
+}
+
+
+/// @brief Explores a subtree, handing sibling branches to idle workers
+/// @param search Shared search state
+/// @param state Subtree root, modified
+/// @return 1: solution found (by this or another worker); 0: subtree exhausted
+static int exploreSubtree(ParallelSearch *search, PropagationState *state) {
+    if (atomic_load_explicit(&search->cancelled, memory_order_relaxed)) {
+        return 1;
+    }
+    if (!propagate(state)) {
+        return 0;
+    }
+    if (state->emptyCount == 0) {
+        pthread_mutex_lock(&search->lock);
+        if (!atomic_load(&search->cancelled)) {
+            search->solution = *state;
+            atomic_store(&search->cancelled, 1);
+            pthread_cond_broadcast(&search->wake);
+        }
+        pthread_mutex_unlock(&search->lock);
+        return 1;
+    }
+
+    int cell = findMostConstrainedSquare(state);
+    unsigned int candidates = state->candidates[cell];
+    while (candidates) {
+        int num = __builtin_ctz(candidates) + 1;
+        candidates &= candidates - 1;
+
+        PropagationState next = *state;
+        STAT_NODE(cell, num);
+        if (!assignDigit(&next, cell, num)) {
+            STAT_UNDO();
+            continue;
+        }
+        // share the branch if someone is waiting, the last branch is always kept
+        if (candidates && atomic_load_explicit(&search->idle, memory_order_relaxed) > 0 && \
+            pushTask(search, &next)) {
+            STAT_UNDO();  // handed over, not searched here
+            continue;
+        }
+        if (exploreSubtree(search, &next)) {
+            return 1;
+        }
+        STAT_UNDO();
+    }
+    return 0;
+}
+
+
+/// @brief Worker thread: explores subtrees until a solution is found or none are left
+/// @param arg ParallelSearch being worked on
+/// @return NULL
+static void *parallelWorker(void *arg) {
+    ParallelSearch *search = arg;
+    PropagationState state;
+#ifdef SOLVER_INSTRUMENTATION
+    // the calling thread runs a worker too, so every worker counts from zero and hands its work over
+    SolverStats outer = solverStats;
+    memset(&solverStats, 0, sizeof(solverStats));
+#endif
+    while (popTask(search, &state)) {
+        exploreSubtree(search, &state);
+    }
+#ifdef SOLVER_INSTRUMENTATION
+    pthread_mutex_lock(&search->lock);
+    mergeSolverStats(&search->stats, &solverStats);
+    pthread_mutex_unlock(&search->lock);
+    solverStats = outer;
+#endif
+    return NULL;
+}
+
+
+/// @brief Splits the top of the search tree into subtrees until every worker has a few
+/// @param search Search to fill with subtrees
+/// @param root Propagated root state with empty squares
+static void splitTopLevels(ParallelSearch *search, const PropagationState *root) {
+    int target = search->threadCount * PARALLEL_TASKS_PER_WORKER;
+    if (target > PARALLEL_MAX_TASKS / 2) {
+        target = PARALLEL_MAX_TASKS / 2;
+    }
+
+    search->tasks[0] = *root;
+    search->taskCount = 1;
+
+    // breadth-first: replace the oldest subtree with its children until there are enough
+    int first = 0;
+    while (first < search->taskCount && search->taskCount - first < target && \
+        search->taskCount + GRID_SIZE <= PARALLEL_MAX_TASKS) {
+        PropagationState parent = search->tasks[first++];
+        if (parent.emptyCount == 0) {
+            first--;  // already solved, leave it for a worker to report
+            break;
+        }
+        int cell = findMostConstrainedSquare(&parent);
+        unsigned int candidates = parent.candidates[cell];
+        while (candidates) {
+            PropagationState child = parent;
+            int num = __builtin_ctz(candidates) + 1;
+            candidates &= candidates - 1;
+            STAT_NODE(cell, num);
+            if (assignDigit(&child, cell, num) && propagate(&child)) {
+                search->tasks[search->taskCount++] = child;
+            }
+            STAT_UNDO();  // searched later by a worker, from depth 0
+
+        }
+    }
+
+    memmove(search->tasks, search->tasks + first, (search->taskCount - first) * sizeof(PropagationState));
+    search->taskCount -= first;
+
+    // stack is popped from the end, reverse so the leftmost subtree goes first
+    for (int i = 0, j = search->taskCount - 1; i < j; ++i, --j) {
+        PropagationState temp = search->tasks[i];
+        search->tasks[i] = search->tasks[j];
+        search->tasks[j] = temp;
+    }
+}
+
+
+/// @brief Solves user grid of one puzzle by searching subtrees on several threads
+/// @param puzzle Puzzle to solve
+/// @param threadCount Number of workers; 0 or less uses every core
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @details The top levels of the propagating search are split into subtrees up front. Workers
+/// \ that run out of work get sibling branches from busy workers. Once any worker finds a
+/// \ solution, the others stop at their next node. User grid is left unchanged if no solution
+/// \ is found.
+int solveSudokuParallel(Puzzle *puzzle, int threadCount) {
+    pthread_t threads[MAX_WORKER_THREADS];
+    ParallelSearch search;
+    PropagationState root;
+
+    if (!loadPropagationState(&root, puzzle->userGrid) || !propagate(&root)) {
+        return 0;
+    }
+    if (root.emptyCount == 0) {
+        storePropagationState(&root, puzzle->userGrid);
+        return 1;
+    }
+
+    if (threadCount <= 0 || threadCount > MAX_WORKER_THREADS) {
+        threadCount = findCoreCount();
+    }
+
+    search.tasks = malloc(PARALLEL_MAX_TASKS * sizeof(PropagationState));
+    if (search.tasks == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    pthread_mutex_init(&search.lock, NULL);
+    pthread_cond_init(&search.wake, NULL);
+    search.threadCount = threadCount;
+    search.done = 0;
+    atomic_init(&search.idle, 0);
+    atomic_init(&search.cancelled, 0);
+#ifdef SOLVER_INSTRUMENTATION
+    memset(&search.stats, 0, sizeof(search.stats));
+#endif
+    STAT_PHASE(SOLVER_PHASE_SEARCH);
+    splitTopLevels(&search, &root);
+
+    prepareSolversForThreads();
+
+    int started = 0;
+    for (int t = 1; t < threadCount; ++t) {
+        if (pthread_create(&threads[started], NULL, parallelWorker, &search) != 0) {
+            break;
+        }
+        started++;
+    }
+    if (started + 1 < threadCount) {
+        // fewer workers than planned, keep popTask() from waiting on threads that never started
+        pthread_mutex_lock(&search.lock);
+        search.threadCount = started + 1;
+        pthread_cond_broadcast(&search.wake);
+        pthread_mutex_unlock(&search.lock);
+    }
+    parallelWorker(&search);
+    for (int t = 0; t < started; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+#ifdef SOLVER_INSTRUMENTATION
+    // worker depths start below the split levels, so maxDepth is a lower bound here
+    mergeSolverStats(&solverStats, &search.stats);
+#endif
+    STAT_PHASE(SOLVER_PHASE_STORE);
+    int solved = atomic_load(&search.cancelled);
+    if (solved) {
+        storePropagationState(&search.solution, puzzle->userGrid);
+    }
+
+    pthread_cond_destroy(&search.wake);
+    pthread_mutex_destroy(&search.lock);
+    free(search.tasks);
+    return solved;
+}
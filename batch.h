@@ -0,0 +1,54 @@
+/**
+ * @file batch.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for batch.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+
+
+/// @brief Upper bound on worker threads
+#define MAX_WORKER_THREADS 256
+/// @brief Largest number of puzzles a worker claims at once
+#define BATCH_MAX_CHUNK 64
+/// @brief Capacity of the shared subtree stack of a parallel search
+#define PARALLEL_MAX_TASKS 1024
+/// @brief Subtrees created up front per worker when splitting the top of the search tree
+#define PARALLEL_TASKS_PER_WORKER 4
+
+
+/// @brief Result of solving a single puzzle in a batch
+typedef enum BatchStatus {
+    /// @brief Not solved yet
+    BATCH_STATUS_PENDING,
+    /// @brief Solved, user grid holds the solution
+    BATCH_STATUS_SOLVED,
+    /// @brief No solution exists, user grid unchanged
+    BATCH_STATUS_UNSOLVABLE
+} BatchStatus;
+
+
+/// @brief Work done for one item of runBatchTasks()
+/// @return Value added to the total returned by runBatchTasks()
+typedef int (*BatchTask)(int index, void *context);
+
+
+int findCoreCount();
+void prepareSolversForThreads();
+long runBatchTasks(int itemCount, BatchTask task, void *context, int threadCount);
+int solvePuzzleBatch(PuzzleArray puzzleArray, int puzzleCount, BatchStatus *statuses, int threadCount);
+long generatePuzzleBatch(Puzzle *puzzles, int count, int clues, int minimal, unsigned long long seed, \
+    long firstIndex, int threadCount);
+int solveSudokuParallel(Puzzle *puzzle, int threadCount);
+
+
+#endif
@@ -0,0 +1,454 @@
+/**
+ * @file bench.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Solver benchmark: runs every engine over fixed-seed corpora and reports throughput and latency
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./canon.h"
+#include "./text.h"
+#include "./ui.h"
+
+
+/// @brief Puzzles per corpus if -n is not given
+#define BENCH_DEFAULT_PUZZLES 100
+/// @brief Seconds one engine may spend on one corpus if -l is not given, the rest is skipped
+#define BENCH_DEFAULT_LIMIT 10.0
+/// @brief Clues left in easy puzzles
+#define BENCH_EASY_CLUES 36
+
+
+/// @brief Corpora the benchmark runs on
+typedef enum BenchCorpus {
+    /// @brief Unique puzzles with #BENCH_EASY_CLUES clues
+    BENCH_CORPUS_EASY,
+    /// @brief Unique puzzles with every clue removed that can be, about 22 to 26 clues
+    BENCH_CORPUS_HARD,
+    /// @brief Transformed copies of known 17-clue puzzles, which are always minimal
+    BENCH_CORPUS_MINIMAL,
+    /// @brief Hard puzzles relabelled so row-major backtracking tries the right digit last
+    BENCH_CORPUS_ADVERSARIAL,
+    /// @brief Number of corpora, not a corpus
+    BENCH_CORPUS_COUNT
+} BenchCorpus;
+
+
+/// @brief Corpus names for -c and the output, in #BenchCorpus order
+static const char *corpusNames[BENCH_CORPUS_COUNT] = {"easy", "hard", "minimal17", "adversarial"};
+
+
+/// @brief Known 17-clue puzzles the minimal corpus is drawn from
+static const char *seventeenClues[] = {
+    "000000010400000000020000000000050407008000300001090000300400200050100000000806000",
+    "000000010400000000020000000000050604008000300001090000300400200050100000000807000",
+    "000000012000035000000600070700000300000400800100000000000120000080000040050000600",
+    "000000012003600000000007000410020000000500300700000600280000040000300500000000000",
+    "000000012008030000000000040120500000000004700060000000507000300000620000000100000"
+};
+
+
+/// @brief Puzzle whose solution starts with 987654321, the first puzzle of the adversarial corpus
+static const char *backtrackerKiller = \
+    "000000000000003085001020000000507000004000100090000000500000073002010000000040009";
+
+
+/// @brief Makes a random solved grid: shuffled diagonal subgrids completed by the solver
+/// @param grid Grid to fill
+/// @param random Corpus random number stream
+static void randomSolvedGrid(int grid[GRID_SIZE][GRID_SIZE], RandomStream *random) {
+    Puzzle puzzle;
+    memset(&puzzle, 0, sizeof(puzzle));
+    for (int box = 0; box < GRID_SIZE; box += SUBGRID_SIZE) {
+        int digits[GRID_SIZE];
+        for (int d = 0; d < GRID_SIZE; ++d) {
+            digits[d] = d + 1;
+        }
+        shuffleValues(digits, GRID_SIZE, random);
+        for (int k = 0; k < GRID_SIZE; ++k) {
+            puzzle.userGrid[box + k / SUBGRID_SIZE][box + k % SUBGRID_SIZE] = digits[k];
+        }
+    }
+    solveSudokuPropagation(&puzzle);
+    memcpy(grid, puzzle.userGrid, sizeof(puzzle.userGrid));
+}
+
+
+/// @brief Removes clues of a solved grid in random order, keeping only removals that leave one solution
+/// @param puzzle Puzzle to fill, grid and user grid get the clues left
+/// @param clues Stop once this many clues are left; 0 tries every square once
+/// @param random Corpus random number stream
+static void carvePuzzle(Puzzle *puzzle, int clues, RandomStream *random) {
+    int order[CELL_COUNT];
+    int left = CELL_COUNT;
+
+    randomSolvedGrid(puzzle->userGrid, random);
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        order[cell] = cell;
+    }
+    shuffleValues(order, CELL_COUNT, random);
+
+    for (int k = 0; k < CELL_COUNT && left > clues; ++k) {
+        int *square = &puzzle->userGrid[order[k] / GRID_SIZE][order[k] % GRID_SIZE];
+        int value = *square;
+        *square = 0;
+        if (hasUniqueSolution(puzzle)) {
+            left--;
+        }
+        else {
+            *square = value;
+        }
+    }
+    memcpy(puzzle->grid, puzzle->userGrid, sizeof(puzzle->grid));
+}
+
+
+/// @brief Relabels digits so the row-major backtracker tries the solution digit of every early square last
+/// @param puzzle Puzzle to relabel, user grid must hold its solution
+/// @details Digits are numbered from 9 down in the order they first appear in the solution's empty
+/// \ squares, row-major. Backtracking tries digits in ascending order, so it meets each right
+/// \ digit as late as possible near the top of its search.
+static void relabelAgainstBacktracker(Puzzle *puzzle) {
+    int labels[GRID_SIZE + 1] = {0};
+    int next = GRID_SIZE;
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int row = cell / GRID_SIZE, col = cell % GRID_SIZE;
+        int value = puzzle->userGrid[row][col];
+        if (puzzle->grid[row][col] == 0 && labels[value] == 0) {
+            labels[value] = next--;
+        }
+    }
+    for (int d = 1; d <= GRID_SIZE; ++d) {
+        if (labels[d] == 0) {
+            labels[d] = next--;
+        }
+    }
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            puzzle->grid[row][col] = labels[puzzle->grid[row][col]];
+        }
+    }
+    memcpy(puzzle->userGrid, puzzle->grid, sizeof(puzzle->grid));
+}
+
+
+/// @brief Builds a corpus, the same seed always gives the same puzzles
+/// @param corpus Corpus to build
+/// @param puzzles Array to fill, holds count puzzles
+/// @param count Puzzles to build
+/// @param seed Master seed, each corpus draws from its own stream of it, see seedRandomStream()
+static void buildCorpus(BenchCorpus corpus, Puzzle *puzzles, int count, unsigned long long seed) {
+    RandomStream random;
+    seedRandomStream(&random, seed, corpus);
+    memset(puzzles, 0, count * sizeof(Puzzle));
+
+    for (int i = 0; i < count; ++i) {
+        Puzzle *puzzle = &puzzles[i];
+        switch (corpus) {
+            case BENCH_CORPUS_EASY:
+                carvePuzzle(puzzle, BENCH_EASY_CLUES, &random);
+                break;
+            case BENCH_CORPUS_HARD:
+                carvePuzzle(puzzle, 0, &random);
+                break;
+            case BENCH_CORPUS_MINIMAL: {
+                Puzzle source;
+                GridTransform transform;
+                int seeds = sizeof(seventeenClues) / sizeof(seventeenClues[0]);
+                parsePuzzleLine(seventeenClues[i % seeds], CELL_COUNT, &source);
+                randomGridTransform(&transform, &random);
+                applyTransform(&transform, source.grid, puzzle->grid);
+                memcpy(puzzle->userGrid, puzzle->grid, sizeof(puzzle->grid));
+                break;
+            }
+            default:
+                if (i == 0) {
+                    parsePuzzleLine(backtrackerKiller, CELL_COUNT, puzzle);
+                    break;
+                }
+                carvePuzzle(puzzle, 0, &random);
+                solveSudokuPropagation(puzzle);
+                relabelAgainstBacktracker(puzzle);
+        }
+    }
+}
+
+
+/// @brief Checks that user grid is a full valid grid that keeps every clue of grid
+/// @return 1: correct solution; 0: otherwise
+static int isCorrectSolution(const Puzzle *puzzle) {
+    for (int unit = 0; unit < GRID_SIZE; ++unit) {
+        int rowSeen = 0, colSeen = 0, boxSeen = 0;
+        for (int k = 0; k < GRID_SIZE; ++k) {
+            int boxRow = (unit / SUBGRID_SIZE) * SUBGRID_SIZE + k / SUBGRID_SIZE;
+            int boxCol = (unit % SUBGRID_SIZE) * SUBGRID_SIZE + k % SUBGRID_SIZE;
+            rowSeen |= 1 << puzzle->userGrid[unit][k];
+            colSeen |= 1 << puzzle->userGrid[k][unit];
+            boxSeen |= 1 << puzzle->userGrid[boxRow][boxCol];
+            if (puzzle->grid[unit][k] != 0 && puzzle->grid[unit][k] != puzzle->userGrid[unit][k]) {
+                return 0;
+            }
+        }
+        int all = ALL_DIGITS_MASK << 1;
+        if (rowSeen != all || colSeen != all || boxSeen != all) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Finds elapsed wall-clock time
+/// @return Seconds since an arbitrary point
+static double wallTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/// @brief Compares latencies for qsort()
+static int compareLatency(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+
+/// @brief Solves every puzzle of a corpus with the selected engine and prints one JSON line of results
+/// @param corpus Corpus being run, for the output
+/// @param puzzles Corpus, left unchanged
+/// @param count Puzzles in corpus
+/// @param seed Seed the corpus was built with, for the output
+/// @param limit Seconds after which the remaining puzzles are skipped
+/// @details Each puzzle is solved on a copy through solveSudokuUncached(), so the solution cache,
+/// \ play tracker and metadata stay out of the timings. Latencies are wall-clock microseconds.
+/// \ Nodes are only counted in builds with -DSOLVER_INSTRUMENTATION, otherwise they are null.
+static void runCorpus(BenchCorpus corpus, const Puzzle *puzzles, int count, unsigned long long seed, double limit) {
+    double *latencies = malloc((count > 0 ? count : 1) * sizeof(double));
+    if (latencies == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    int run = 0, failed = 0;
+    long nodes = 0;
+    double start = wallTime();
+    while (run < count && wallTime() - start < limit) {
+        Puzzle puzzle = puzzles[run];
+        double solveStart = wallTime();
+        int solved = solveSudokuUncached(&puzzle, 0, 0);
+        latencies[run++] = (wallTime() - solveStart) * 1e6;
+        nodes += solverStats.nodes;
+        if (!solved || !isCorrectSolution(&puzzle)) {
+            failed++;
+        }
+    }
+    double seconds = wallTime() - start;
+
+    qsort(latencies, run, sizeof(double), compareLatency);
+    double p50 = run > 0 ? latencies[(run - 1) / 2] : 0;
+    double p99 = run > 0 ? latencies[(int)((run - 1) * 0.99)] : 0;
+    double max = run > 0 ? latencies[run - 1] : 0;
+
+    printf("{\"engine\":\"%s\",\"corpus\":\"%s\",\"seed\":%llu,\"puzzles\":%d,\"skipped\":%d,\"failed\":%d,"
+        "\"seconds\":%.6f,\"puzzles_per_second\":%.1f,\"p50_us\":%.2f,\"p99_us\":%.2f,\"max_us\":%.2f,"
+        "\"nodes_per_solve\":", solverEngineName(solverEngine), corpusNames[corpus], seed, run, count - run,
+        failed, seconds, seconds > 0 ? run / seconds : 0.0, p50, p99, max);
+    if (solverInstrumentationEnabled()) {
+        printf("%.1f}\n", run > 0 ? (double)nodes / run : 0.0);
+    }
+    else {
+        printf("null}\n");
+    }
+    fflush(stdout);
+    free(latencies);
+}
+
+
+/// @brief Solver the solution cache calls on a miss, the selected engine on the whole grid
+static int solveWithEngine(Puzzle *puzzle) {
+    return solveSudokuUncached(puzzle, 0, 0);
+}
+
+
+/// @brief Solves puzzles through the solution cache and records wall-clock latencies
+/// @param puzzles Puzzles to solve copies of, left unchanged
+/// @param count Puzzles to solve
+/// @param latencies Receives count latencies in microseconds, sorted
+/// @param failed Incremented per wrong or missing solution
+/// @return Cache hits among the solves
+static long timeCachedSolves(const Puzzle *puzzles, int count, double *latencies, int *failed) {
+    long hits = solutionCacheStats.hits;
+    for (int i = 0; i < count; ++i) {
+        Puzzle puzzle = puzzles[i];
+        double solveStart = wallTime();
+        int solved = solveSudokuCached(&puzzle, solveWithEngine);
+        latencies[i] = (wallTime() - solveStart) * 1e6;
+        if (!solved || !isCorrectSolution(&puzzle)) {
+            (*failed)++;
+        }
+    }
+    qsort(latencies, count, sizeof(double), compareLatency);
+    return solutionCacheStats.hits - hits;
+}
+
+
+/// @brief Times the solution cache on a corpus with the selected engine and prints one JSON line
+/// @param corpus Corpus being run, for the output
+/// @param puzzles Corpus, left unchanged
+/// @param count Puzzles in corpus
+/// @param seed Seed the corpus was built with, also seeds the symmetric copies
+/// @param limit Seconds the uncached pass may take, the rest is skipped in every pass
+/// @details Starting from an empty cache, the corpus is solved without the cache, then through it
+/// \ three times: once cold (misses), once again (exact hits), and once as random symmetric
+/// \ copies, which hit the symmetric level only while canonicalising is cheaper than solving.
+/// \ p50 latencies of each pass and the hits of the last two are printed.
+static void runCacheCorpus(BenchCorpus corpus, const Puzzle *puzzles, int count, unsigned long long seed, double limit) {
+    double *latencies = malloc((count > 0 ? count : 1) * sizeof(double));
+    Puzzle *symmetric = malloc((count > 0 ? count : 1) * sizeof(Puzzle));
+    if (latencies == NULL || symmetric == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    int run = 0, failed = 0;
+    double start = wallTime();
+    while (run < count && wallTime() - start < limit) {
+        Puzzle puzzle = puzzles[run];
+        double solveStart = wallTime();
+        if (!solveSudokuUncached(&puzzle, 0, 0) || !isCorrectSolution(&puzzle)) {
+            failed++;
+        }
+        latencies[run++] = (wallTime() - solveStart) * 1e6;
+    }
+    qsort(latencies, run, sizeof(double), compareLatency);
+    double solveP50 = run > 0 ? latencies[(run - 1) / 2] : 0;
+
+    RandomStream random;
+    seedRandomStream(&random, seed, BENCH_CORPUS_COUNT + corpus);
+    for (int i = 0; i < run; ++i) {
+        Puzzle source = puzzles[i];
+        GridTransform transform;
+        randomGridTransform(&transform, &random);
+        applyTransform(&transform, source.grid, symmetric[i].grid);
+        memcpy(symmetric[i].userGrid, symmetric[i].grid, sizeof(symmetric[i].grid));
+    }
+
+    clearSolutionCache();
+    timeCachedSolves(puzzles, run, latencies, &failed);
+    double missP50 = run > 0 ? latencies[(run - 1) / 2] : 0;
+    long exactHits = timeCachedSolves(puzzles, run, latencies, &failed);
+    double exactP50 = run > 0 ? latencies[(run - 1) / 2] : 0;
+    long symmetricHits = timeCachedSolves(symmetric, run, latencies, &failed);
+    double symmetricP50 = run > 0 ? latencies[(run - 1) / 2] : 0;
+
+    printf("{\"engine\":\"%s\",\"corpus\":\"%s\",\"seed\":%llu,\"puzzles\":%d,\"skipped\":%d,\"failed\":%d,"
+        "\"solve_p50_us\":%.2f,\"miss_p50_us\":%.2f,\"exact_hit_p50_us\":%.2f,\"exact_hits\":%ld,"
+        "\"symmetric_p50_us\":%.2f,\"symmetric_hits\":%ld}\n", solverEngineName(solverEngine), corpusNames[corpus],
+        seed, run, count - run, failed, solveP50, missP50, exactP50, exactHits, symmetricP50, symmetricHits);
+    fflush(stdout);
+    free(symmetric);
+    free(latencies);
+}
+
+
+/// @brief Prints benchmark usage to stderr
+static void printUsage() {
+    char *keys[] = {"BENCH_USAGE_1", "BENCH_USAGE_2", "BENCH_USAGE_3", "BENCH_USAGE_4", "BENCH_USAGE_5", \
+        "BENCH_USAGE_6", "BENCH_USAGE_7"};
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); ++k) {
+        fprintf(stderr, "%s\n", translate(keys[k]));
+    }
+}
+
+
+/// @brief Runs the benchmark
+/// @details Options: -n puzzles per corpus, -s seed, -e engine, -c corpus, -l seconds per engine and corpus,
+/// \ -k 1 to time the solution cache instead of the engines alone.
+/// \ Prints one JSON object per engine and corpus to stdout, so runs on different commits can be diffed.
+int main(int argc, char *argv[]) {
+    int count = BENCH_DEFAULT_PUZZLES;
+    unsigned long long seed = 1;
+    double limit = BENCH_DEFAULT_LIMIT;
+    int onlyEngine = SOLVER_ENGINE_COUNT;
+    int onlyCorpus = BENCH_CORPUS_COUNT;
+    int cache = 0;
+    int valid = 1;
+
+    for (int a = 1; valid && a < argc; a += 2) {
+        if (argv[a][0] != '-' || argv[a][1] == '\0' || argv[a][2] != '\0' || a + 1 >= argc) {
+            valid = 0;
+            break;
+        }
+        char *value = argv[a + 1];
+        switch (argv[a][1]) {
+            case 'n':
+                valid = sscanf(value, "%d", &count) == 1 && count > 0;
+                break;
+            case 's':
+                valid = sscanf(value, "%llu", &seed) == 1;
+                break;
+            case 'l':
+                valid = sscanf(value, "%lf", &limit) == 1 && limit > 0;
+                break;
+            case 'e':
+                onlyEngine = findSolverEngine(value);
+                valid = onlyEngine != SOLVER_ENGINE_COUNT;
+                break;
+            case 'k':
+                valid = sscanf(value, "%d", &cache) == 1 && (cache == 0 || cache == 1);
+                break;
+            case 'c':
+                valid = 0;
+                for (int c = 0; c < BENCH_CORPUS_COUNT; ++c) {
+                    if (strcmp(value, corpusNames[c]) == 0) {
+                        onlyCorpus = c;
+                        valid = 1;
+                    }
+                }
+                break;
+            default:
+                valid = 0;
+        }
+    }
+    if (!valid) {
+        printUsage();
+        return 1;
+    }
+
+    Puzzle *puzzles = malloc(count * sizeof(Puzzle));
+    if (puzzles == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    initSolverTables();
+    for (int c = 0; c < BENCH_CORPUS_COUNT; ++c) {
+        if (onlyCorpus != BENCH_CORPUS_COUNT && c != onlyCorpus) {
+            continue;
+        }
+        buildCorpus(c, puzzles, count, seed);
+        for (int e = 0; e < SOLVER_ENGINE_COUNT; ++e) {
+            if (onlyEngine != SOLVER_ENGINE_COUNT && e != onlyEngine) {
+                continue;
+            }
+            solverEngine = e;
+            if (cache) {
+                runCacheCorpus(c, puzzles, count, seed, limit);
+            }
+            else {
+                runCorpus(c, puzzles, count, seed, limit);
+            }
+        }
+    }
+
+    free(puzzles);
+    return 0;
+}
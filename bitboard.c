@@ -0,0 +1,314 @@
+/**
+ * @file bitboard.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief SIMD bitboard solver using one register per digit plane
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./bitboard.h"
+
+
+#if defined(__SSE2__)
+
+static inline Bitboard bbMake(uint64_t lo, uint64_t hi) { return _mm_set_epi64x((long long)hi, (long long)lo); }
+static inline Bitboard bbAnd(Bitboard a, Bitboard b) { return _mm_and_si128(a, b); }
+static inline Bitboard bbOr(Bitboard a, Bitboard b) { return _mm_or_si128(a, b); }
+/// a & ~b
+static inline Bitboard bbAndNot(Bitboard a, Bitboard b) { return _mm_andnot_si128(b, a); }
+static inline uint64_t bbLo(Bitboard a) { return (uint64_t)_mm_cvtsi128_si64(a); }
+static inline uint64_t bbHi(Bitboard a) { return (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(a, a)); }
+static inline int bbIsZero(Bitboard a) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#else
+
+static inline Bitboard bbMake(uint64_t lo, uint64_t hi) { Bitboard r = {lo, hi}; return r; }
+static inline Bitboard bbAnd(Bitboard a, Bitboard b) { return bbMake(a.lo & b.lo, a.hi & b.hi); }
+static inline Bitboard bbOr(Bitboard a, Bitboard b) { return bbMake(a.lo | b.lo, a.hi | b.hi); }
+/// a & ~b
+static inline Bitboard bbAndNot(Bitboard a, Bitboard b) { return bbMake(a.lo & ~b.lo, a.hi & ~b.hi); }
+static inline uint64_t bbLo(Bitboard a) { return a.lo; }
+static inline uint64_t bbHi(Bitboard a) { return a.hi; }
+static inline int bbIsZero(Bitboard a) { return (a.lo | a.hi) == 0; }
+
+#endif
+
+/// 1 if exactly one square is set, checked without a popcount
+static inline int bbIsSingle(Bitboard a) {
+    uint64_t lo = bbLo(a), hi = bbHi(a);
+    return lo ? (!hi && !(lo & (lo - 1))) : (hi && !(hi & (hi - 1)));
+}
+/// Index of the lowest set square, a must not be zero
+static inline int bbFirst(Bitboard a) {
+    uint64_t lo = bbLo(a);
+    return lo ? __builtin_ctzll(lo) : 64 + __builtin_ctzll(bbHi(a));
+}
+
+
+/// @brief Every square of the grid
+static Bitboard fullBoard;
+/// @brief Single bit of each square
+static Bitboard squareBits[CELL_COUNT];
+/// @brief Squares sharing a unit with each square, not including the square itself
+static Bitboard peerBits[CELL_COUNT];
+/// @brief Squares of every unit: rows first, then columns, then subgrids
+static Bitboard unitBits[UNIT_COUNT];
+/// @brief Set once the masks above have been filled in
+static int masksReady = 0;
+
+
+/// @brief Builds a bitboard from a row-major square index
+/// @param cell Row-major square index
+/// @return Bitboard with only that square set
+static Bitboard squareBit(int cell) {
+    return cell < 64 ? bbMake(1ull << cell, 0) : bbMake(0, 1ull << (cell - 64));
+}
+
+
+/// @brief Fills in the square, peer and unit masks
+/// @note Called automatically by loadBitboardState(), safe to call more than once
+void initBitboardMasks() {
+    if (masksReady) {
+        return;
+    }
+
+    fullBoard = bbMake(~0ull, (1ull << (CELL_COUNT - 64)) - 1);
+    for (int unit = 0; unit < UNIT_COUNT; ++unit) {
+        unitBits[unit] = bbMake(0, 0);
+    }
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int row = cell / GRID_SIZE;
+        int col = cell % GRID_SIZE;
+        squareBits[cell] = squareBit(cell);
+        unitBits[row] = bbOr(unitBits[row], squareBits[cell]);
+        unitBits[GRID_SIZE + col] = bbOr(unitBits[GRID_SIZE + col], squareBits[cell]);
+        unitBits[2 * GRID_SIZE + boxOfSquare(row, col)] = bbOr(unitBits[2 * GRID_SIZE + boxOfSquare(row, col)], squareBits[cell]);
+    }
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int row = cell / GRID_SIZE;
+        int col = cell % GRID_SIZE;
+        Bitboard peers = bbOr(unitBits[row], bbOr(unitBits[GRID_SIZE + col], unitBits[2 * GRID_SIZE + boxOfSquare(row, col)]));
+        peerBits[cell] = bbAndNot(peers, squareBits[cell]);
+    }
+
+    masksReady = 1;
+}
+
+
+/// @brief Writes a digit to a square: clears the square from other planes and the digit from peers
+/// @param state State to modify
+/// @param cell Row-major square index
+/// @param num Digit to write (1-9)
+static void placeBitboardDigit(BitboardState *state, int cell, int num) {
+    Bitboard bit = squareBits[cell];
+    for (int d = 0; d < GRID_SIZE; ++d) {
+        state->digits[d] = bbAndNot(state->digits[d], bit);
+    }
+    state->digits[num - 1] = bbOr(bbAndNot(state->digits[num - 1], peerBits[cell]), bit);
+    state->solved = bbOr(state->solved, bit);
+}
+
+
+/// @brief Finds the digit that can still go in a square
+/// @param state State to check
+/// @param cell Row-major square index
+/// @return Lowest candidate digit; 0 if none
+static int firstCandidate(const BitboardState *state, int cell) {
+    for (int d = 0; d < GRID_SIZE; ++d) {
+        if (!bbIsZero(bbAnd(state->digits[d], squareBits[cell]))) {
+            return d + 1;
+        }
+    }
+    return 0;
+}
+
+
+/// @brief Applies naked singles and hidden singles on all planes until nothing changes
+/// @param state State to modify
+/// @return 1: no contradiction found; 0: state cannot be solved
+/// @details Candidate counts per square are bit-sliced over the planes: a square is a naked
+/// \ single if it is covered by exactly one plane, so the whole board is checked at once.
+static int propagateBitboard(BitboardState *state) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+
+        Bitboard unsolved = bbAndNot(fullBoard, state->solved);
+        if (bbIsZero(unsolved)) {
+            return 1;
+        }
+
+        Bitboard once = bbMake(0, 0), twice = bbMake(0, 0);
+        for (int d = 0; d < GRID_SIZE; ++d) {
+            Bitboard plane = bbAnd(state->digits[d], unsolved);
+            twice = bbOr(twice, bbAnd(once, plane));
+            once = bbOr(once, plane);
+        }
+        if (!bbIsZero(bbAndNot(unsolved, once))) {
+            return 0;
+        }
+
+        Bitboard singles = bbAndNot(once, twice);
+        while (!bbIsZero(singles)) {
+            int cell = bbFirst(singles);
+            singles = bbAndNot(singles, squareBits[cell]);
+            int num = firstCandidate(state, cell);
+            if (num == 0) {
+                return 0;
+            }
+            placeBitboardDigit(state, cell, num);
+            STAT_PROPAGATE();
+            changed = 1;
+        }
+        if (changed) {
+            continue;
+        }
+
+        for (int d = 0; d < GRID_SIZE; ++d) {
+            for (int unit = 0; unit < UNIT_COUNT; ++unit) {
+                Bitboard places = bbAnd(state->digits[d], unitBits[unit]);
+                Bitboard open = bbAndNot(places, state->solved);
+                if (bbIsSingle(open)) {
+                    placeBitboardDigit(state, bbFirst(open), d + 1);
+                    STAT_PROPAGATE();
+                    changed = 1;
+                }
+                else if (bbIsZero(places)) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Picks the square to branch on, preferring squares with two or three candidates
+/// @param state State to check, must have unsolved squares
+/// @return Row-major square index
+static int pickBranchSquare(const BitboardState *state) {
+    Bitboard unsolved = bbAndNot(fullBoard, state->solved);
+    Bitboard one = bbMake(0, 0), two = bbMake(0, 0), three = bbMake(0, 0), four = bbMake(0, 0);
+    for (int d = 0; d < GRID_SIZE; ++d) {
+        Bitboard plane = bbAnd(state->digits[d], unsolved);
+        four = bbOr(four, bbAnd(three, plane));
+        three = bbOr(three, bbAnd(two, plane));
+        two = bbOr(two, bbAnd(one, plane));
+        one = bbOr(one, plane);
+    }
+
+    Bitboard exactlyTwo = bbAndNot(two, three);
+    if (!bbIsZero(exactlyTwo)) {
+        return bbFirst(exactlyTwo);
+    }
+    Bitboard exactlyThree = bbAndNot(three, four);
+    if (!bbIsZero(exactlyThree)) {
+        return bbFirst(exactlyThree);
+    }
+    return bbFirst(unsolved);
+}
+
+
+/// @brief Builds bitboard state from a grid
+/// @param state State to fill
+/// @param grid Grid to read values from
+/// @return 1: loaded; 0: grid values contradict each other
+int loadBitboardState(BitboardState *state, int grid[GRID_SIZE][GRID_SIZE]) {
+    initBitboardMasks();
+
+    for (int d = 0; d < GRID_SIZE; ++d) {
+        state->digits[d] = fullBoard;
+    }
+    state->solved = bbMake(0, 0);
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int num = grid[cell / GRID_SIZE][cell % GRID_SIZE];
+        if (num <= 0) {
+            continue;
+        }
+        if (num > GRID_SIZE || !bbIsZero(bbAnd(state->solved, squareBits[cell])) || \
+            bbIsZero(bbAnd(state->digits[num - 1], squareBits[cell]))) {
+            return 0;
+        }
+        placeBitboardDigit(state, cell, num);
+    }
+    return 1;
+}
+
+
+/// @brief Writes bitboard state values back to a grid
+/// @param state State to read
+/// @param grid Grid to write values to, unsolved squares become 0
+void storeBitboardState(const BitboardState *state, int grid[GRID_SIZE][GRID_SIZE]) {
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        grid[cell / GRID_SIZE][cell % GRID_SIZE] = 0;
+    }
+    for (int d = 0; d < GRID_SIZE; ++d) {
+        Bitboard placed = bbAnd(state->digits[d], state->solved);
+        while (!bbIsZero(placed)) {
+            int cell = bbFirst(placed);
+            placed = bbAndNot(placed, squareBits[cell]);
+            grid[cell / GRID_SIZE][cell % GRID_SIZE] = d + 1;
+        }
+    }
+}
+
+
+/// @brief Solves bitboard state
+/// @param state State to solve, holds the solution if one is found
+/// @return 1: solved; 0: unsolvable
+/// @details Propagates, then branches on a square with few candidates. The whole state is
+/// \ ten registers, so each branch works on a copy.
+int solveBitboardState(BitboardState *state) {
+    if (!propagateBitboard(state)) {
+        return 0;
+    }
+    if (bbIsZero(bbAndNot(fullBoard, state->solved))) {
+        return 1;
+    }
+
+    int cell = pickBranchSquare(state);
+    for (int d = 0; d < GRID_SIZE; ++d) {
+        if (bbIsZero(bbAnd(state->digits[d], squareBits[cell]))) {
+            continue;
+        }
+        BitboardState next = *state;
+        placeBitboardDigit(&next, cell, d + 1);
+        STAT_NODE(cell, d + 1);
+        if (solveBitboardState(&next)) {
+            *state = next;
+            return 1;
+        }
+        STAT_UNDO();
+    }
+    return 0;
+}
+
+
+/// @brief Solves user grid of puzzle using the SIMD bitboard engine
+/// @param puzzle Puzzle to solve
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @note User grid is left unchanged if no solution is found
+int solveSudokuBitboard(Puzzle *puzzle) {
+    BitboardState state;
+    if (!loadBitboardState(&state, puzzle->userGrid)) {
+        return 0;
+    }
+    STAT_PHASE(SOLVER_PHASE_SEARCH);
+    if (!solveBitboardState(&state)) {
+        return 0;
+    }
+    STAT_PHASE(SOLVER_PHASE_STORE);
+    storeBitboardState(&state, puzzle->userGrid);
+    return 1;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file bitboard.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for bitboard.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+#if defined(__SSE2__)
+/// @brief One bit per square (bit n == row-major square n), held in a single SSE register
+typedef __m128i Bitboard;
+#else
+/// @brief One bit per square (bit n == row-major square n), portable fallback without SSE2
+typedef struct Bitboard {
+    /// @brief Squares 0-63
+    uint64_t lo;
+    /// @brief Squares 64-80
+    uint64_t hi;
+} Bitboard;
+#endif
+
+
+/// @brief Board stored as one candidate plane per digit plus a plane of filled squares
+/// @details Digit plane n has a bit for every square where n can still go, and for the square
+/// \ where n was placed. Whole-board operations are a handful of bitwise register instructions.
+typedef struct BitboardState {
+    /// @brief Candidate plane of each digit, digit n at index (n - 1)
+    Bitboard digits[GRID_SIZE];
+    /// @brief Squares that have been filled
+    Bitboard solved;
+} BitboardState;
+
+
+void initBitboardMasks();
+int loadBitboardState(BitboardState *state, int grid[GRID_SIZE][GRID_SIZE]);
+void storeBitboardState(const BitboardState *state, int grid[GRID_SIZE][GRID_SIZE]);
+int solveBitboardState(BitboardState *state);
+int solveSudokuBitboard(Puzzle *puzzle);
+
+
+#endif
@@ -0,0 +1,693 @@
+/**
+ * @file canon.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Symmetry canonicalisation of grids, solution cache keyed by canonical form
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./canon.h"
+#include "./ui.h"
+
+
+/// @brief Number of ways to order the columns while keeping stacks together (3! * 3!^3)
+#define COLUMN_ORDER_COUNT 1296
+
+
+/// @brief Partially built transform, rows are chosen one level at a time
+typedef struct CanonCandidate {
+    unsigned char transpose;
+    unsigned char rows[GRID_SIZE];
+    unsigned char cols[GRID_SIZE];
+    /// @brief New digit of each source digit, 0 == not seen yet
+    unsigned char labels[GRID_SIZE + 1];
+    /// @brief Label given to the next unseen digit
+    unsigned char nextLabel;
+    /// @brief Source rows already chosen, one bit per row
+    unsigned short usedRows;
+} CanonCandidate;
+
+
+/// @brief Frontiers of the level-by-level search, one is read while the other is filled
+typedef struct CanonSearch {
+    CanonCandidate frontiers[2][CANON_MAX_FRONTIER];
+    /// @brief Size of the frontier being filled
+    int nextCount;
+    /// @brief Smallest row found so far on the current level
+    unsigned char bestLine[GRID_SIZE];
+} CanonSearch;
+
+
+/// @brief One cached canonical puzzle and its solution
+typedef struct CacheEntry {
+    unsigned char puzzle[CELL_COUNT];
+    unsigned char solution[CELL_COUNT];
+    /// @brief 1: entry holds a puzzle
+    unsigned char used;
+    /// @brief 0: puzzle is known to be unsolvable
+    unsigned char solved;
+    /// @brief Cache clock value of the last lookup or insert, for replacement
+    unsigned int lastUse;
+} CacheEntry;
+
+
+/// @brief One level of the solution cache, set-associative with a lock per set
+typedef struct CacheLevel {
+    CacheEntry entries[CACHE_SETS][CACHE_WAYS];
+    /// @brief Guards the entries of each set
+    pthread_mutex_t locks[CACHE_SETS];
+} CacheLevel;
+
+
+/// @brief Measured costs that decide whether the symmetric level is worth using
+typedef struct CacheCosts {
+    /// @brief Seconds spent in canonicalizeGrid()
+    double canonSeconds;
+    /// @brief Number of canonicalizeGrid() calls timed
+    long canonCount;
+    /// @brief Seconds spent solving on misses
+    double solveSeconds;
+    /// @brief Number of misses timed
+    long solveCount;
+} CacheCosts;
+
+
+/// @brief 1: solveSudokuUserGrid() goes through the solution cache
+int solutionCacheEnabled = 0;
+/// @brief 1: persistSolutionCache() keeps the cache in #CACHE_FILENAME between runs
+int solutionCachePersistent = 0;
+/// @brief Counters of the solution cache
+SolutionCacheStats solutionCacheStats;
+
+/// @brief Search space reused by canonicalizeGrid() calls on the same thread
+static _Thread_local CanonSearch canonSearch;
+/// @brief Every column order, built on first use
+static int columnOrders[COLUMN_ORDER_COUNT][GRID_SIZE];
+static pthread_once_t columnOrdersOnce = PTHREAD_ONCE_INIT;
+/// @brief Puzzles exactly as they were solved, looked up first
+static CacheLevel exactLevel;
+/// @brief Puzzles in canonical form, looked up on a miss in exactLevel, see useSymmetricLevel()
+static CacheLevel symmetricLevel;
+/// @brief Initialises the locks of both levels once
+static pthread_once_t cacheLocksOnce = PTHREAD_ONCE_INIT;
+/// @brief Replacement clock of both levels
+static atomic_uint cacheClock;
+/// @brief Costs measured so far, guarded by cacheStatsLock
+static CacheCosts cacheCosts;
+/// @brief Guards solutionCacheStats and cacheCosts
+static pthread_mutex_t cacheStatsLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/// @brief Fills in every column order that keeps stacks together
+/// @note Run once through columnOrdersOnce
+static void initColumnOrders() {
+    static const int perms[6][SUBGRID_SIZE] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+    int order = 0;
+    for (int stacks = 0; stacks < 6; ++stacks) {
+        for (int a = 0; a < 6; ++a) {
+            for (int b = 0; b < 6; ++b) {
+                for (int c = 0; c < 6; ++c) {
+                    int within[SUBGRID_SIZE] = {a, b, c};
+                    for (int s = 0; s < SUBGRID_SIZE; ++s) {
+                        int stack = perms[stacks][s];
+                        for (int k = 0; k < SUBGRID_SIZE; ++k) {
+                            columnOrders[order][s * SUBGRID_SIZE + k] = stack * SUBGRID_SIZE + perms[within[s]][k];
+                        }
+                    }
+                    order++;
+                }
+            }
+        }
+    }
+}
+
+
+/// @brief Tries a source row as the next row of a candidate, keeps it if it ties or beats the best row
+/// @param search Search to add to
+/// @param grid Source grid
+/// @param base Candidate to extend
+/// @param level Transformed row being chosen
+/// @param row Source row to try
+static void offerRow(CanonSearch *search, int grid[GRID_SIZE][GRID_SIZE], const CanonCandidate *base, int level, int row) {
+    unsigned char labels[GRID_SIZE + 1];
+    unsigned char line[GRID_SIZE];
+    int nextLabel = base->nextLabel;
+    int cmp = search->nextCount ? 0 : -1;
+
+    memcpy(labels, base->labels, sizeof(labels));
+    for (int j = 0; j < GRID_SIZE; ++j) {
+        int col = base->cols[j];
+        int value = base->transpose ? grid[col][row] : grid[row][col];
+        if (value > 0 && labels[value] == 0) {
+            labels[value] = nextLabel++;
+        }
+        line[j] = value > 0 ? labels[value] : GRID_SIZE + 1;
+        if (cmp == 0 && line[j] != search->bestLine[j]) {
+            cmp = line[j] < search->bestLine[j] ? -1 : 1;
+            if (cmp > 0) {
+                return;
+            }
+        }
+    }
+
+    if (cmp < 0) {
+        memcpy(search->bestLine, line, GRID_SIZE);
+        search->nextCount = 0;
+    }
+    if (search->nextCount == CANON_MAX_FRONTIER) {
+        return;
+    }
+
+    CanonCandidate *candidate = &search->frontiers[(level + 1) % 2][search->nextCount++];
+    *candidate = *base;
+    candidate->rows[level] = row;
+    candidate->usedRows |= 1u << row;
+    candidate->nextLabel = nextLabel;
+    memcpy(candidate->labels, labels, sizeof(labels));
+}
+
+
+/// @brief Tries every source row allowed next by the band structure
+static void offerRows(CanonSearch *search, int grid[GRID_SIZE][GRID_SIZE], const CanonCandidate *base, int level) {
+    if (level % SUBGRID_SIZE == 0) {
+        for (int row = 0; row < GRID_SIZE; ++row) {
+            int bandMask = ((1u << SUBGRID_SIZE) - 1) << (row / SUBGRID_SIZE * SUBGRID_SIZE);
+            if (!(base->usedRows & bandMask)) {
+                offerRow(search, grid, base, level, row);
+            }
+        }
+    }
+    else {
+        int band = base->rows[level - 1] / SUBGRID_SIZE;
+        for (int row = band * SUBGRID_SIZE; row < (band + 1) * SUBGRID_SIZE; ++row) {
+            if (!(base->usedRows & (1u << row))) {
+                offerRow(search, grid, base, level, row);
+            }
+        }
+    }
+}
+
+
+/// @brief Transforms a grid
+/// @param transform Transform to apply
+/// @param grid Grid to read
+/// @param result Grid to write, must not be grid
+void applyTransform(const GridTransform *transform, int grid[GRID_SIZE][GRID_SIZE], int result[GRID_SIZE][GRID_SIZE]) {
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            int row = transform->rows[i];
+            int col = transform->cols[j];
+            result[i][j] = transform->labels[transform->transpose ? grid[col][row] : grid[row][col]];
+        }
+    }
+}
+
+
+/// @brief Makes a random symmetry transform, which keeps every solution grid valid
+/// @param transform Transform to fill
+/// @param random Stream to draw from; NULL uses rand()
+/// @details Draws uniformly from the 2 * 6^8 * 9! transforms: transposition, band and stack
+/// \ order, row order within each band, column order within each stack and digit relabelling.
+void randomGridTransform(GridTransform *transform, RandomStream *random) {
+    int bands[SUBGRID_SIZE], stacks[SUBGRID_SIZE], inner[SUBGRID_SIZE];
+    for (int b = 0; b < SUBGRID_SIZE; ++b) {
+        bands[b] = stacks[b] = b;
+    }
+    shuffleValues(bands, SUBGRID_SIZE, random);
+    shuffleValues(stacks, SUBGRID_SIZE, random);
+
+    for (int b = 0; b < SUBGRID_SIZE; ++b) {
+        for (int k = 0; k < SUBGRID_SIZE; ++k) {
+            inner[k] = k;
+        }
+        shuffleValues(inner, SUBGRID_SIZE, random);
+        for (int k = 0; k < SUBGRID_SIZE; ++k) {
+            transform->rows[b * SUBGRID_SIZE + k] = bands[b] * SUBGRID_SIZE + inner[k];
+        }
+        shuffleValues(inner, SUBGRID_SIZE, random);
+        for (int k = 0; k < SUBGRID_SIZE; ++k) {
+            transform->cols[b * SUBGRID_SIZE + k] = stacks[b] * SUBGRID_SIZE + inner[k];
+        }
+    }
+
+    transform->labels[0] = 0;
+    for (int d = 1; d <= GRID_SIZE; ++d) {
+        transform->labels[d] = d;
+    }
+    shuffleValues(transform->labels + 1, GRID_SIZE, random);
+    transform->transpose = randomBelow(random, 2);
+}
+
+
+/// @brief Reverts applyTransform()
+/// @param transform Transform that produced grid
+/// @param grid Transformed grid to read
+/// @param result Grid to write, must not be grid
+void applyInverseTransform(const GridTransform *transform, int grid[GRID_SIZE][GRID_SIZE], int result[GRID_SIZE][GRID_SIZE]) {
+    int digits[GRID_SIZE + 1];
+    for (int d = 0; d <= GRID_SIZE; ++d) {
+        digits[transform->labels[d]] = d;
+    }
+
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            int row = transform->rows[i];
+            int col = transform->cols[j];
+            if (transform->transpose) {
+                result[col][row] = digits[grid[i][j]];
+            }
+            else {
+                result[row][col] = digits[grid[i][j]];
+            }
+        }
+    }
+}
+
+
+/// @brief Maps a grid to the representative of its symmetry class
+/// @param grid Grid to read, 0 == empty
+/// @param canonical Receives the representative
+/// @param transform Receives the transform from grid to canonical
+/// @return 1: done; 0: grid has values out of range
+/// @details The representative is the lexicographically smallest grid (row-major, empty squares last)
+/// \ among the transforms that put one of the fullest rows or columns first: transposition, band and
+/// \ row swaps, stack and column swaps, with digits relabelled in order of first appearance. Rows are fixed one level at a time: every transform that ties for the
+/// \ smallest row so far is kept, the rest are dropped. Sorting empty squares last puts the
+/// \ fullest rows first, which leaves far fewer ties than sorting them first.
+int canonicalizeGrid(int grid[GRID_SIZE][GRID_SIZE], int canonical[GRID_SIZE][GRID_SIZE], GridTransform *transform) {
+    CanonSearch *search = &canonSearch;
+
+    // Clues per row ([0]) and per column ([1]); only the fullest lines can come first
+    int clues[2][GRID_SIZE] = {{0}};
+    int mostClues = 0;
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            if (grid[i][j] < 0 || grid[i][j] > GRID_SIZE) {
+                return 0;
+            }
+            clues[0][i] += grid[i][j] > 0;
+            clues[1][j] += grid[i][j] > 0;
+        }
+    }
+    for (int k = 0; k < GRID_SIZE; ++k) {
+        mostClues = clues[0][k] > mostClues ? clues[0][k] : mostClues;
+        mostClues = clues[1][k] > mostClues ? clues[1][k] : mostClues;
+    }
+    pthread_once(&columnOrdersOnce, initColumnOrders);
+
+    search->nextCount = 0;
+    for (int transpose = 0; transpose <= 1; ++transpose) {
+        for (int row = 0; row < GRID_SIZE; ++row) {
+            if (clues[transpose][row] != mostClues) {
+                continue;
+            }
+            for (int order = 0; order < COLUMN_ORDER_COUNT; ++order) {
+                CanonCandidate seed;
+                memset(&seed, 0, sizeof(seed));
+                seed.transpose = transpose;
+                seed.nextLabel = 1;
+                for (int j = 0; j < GRID_SIZE; ++j) {
+                    seed.cols[j] = columnOrders[order][j];
+                }
+                offerRow(search, grid, &seed, 0, row);
+            }
+        }
+    }
+
+    for (int level = 1; level < GRID_SIZE; ++level) {
+        CanonCandidate *current = search->frontiers[level % 2];
+        int count = search->nextCount;
+        search->nextCount = 0;
+        for (int k = 0; k < count; ++k) {
+            offerRows(search, grid, &current[k], level);
+        }
+    }
+
+    CanonCandidate *best = &search->frontiers[GRID_SIZE % 2][0];
+    transform->transpose = best->transpose;
+    for (int k = 0; k < GRID_SIZE; ++k) {
+        transform->rows[k] = best->rows[k];
+        transform->cols[k] = best->cols[k];
+    }
+    int nextLabel = best->nextLabel;
+    transform->labels[0] = 0;
+    for (int d = 1; d <= GRID_SIZE; ++d) {
+        transform->labels[d] = best->labels[d] ? best->labels[d] : nextLabel++;
+    }
+
+    applyTransform(transform, grid, canonical);
+    return 1;
+}
+
+
+/// @brief FNV-1a hash of a packed grid
+static unsigned int hashCells(const unsigned char cells[CELL_COUNT]) {
+    unsigned int hash = 2166136261u;
+    for (int k = 0; k < CELL_COUNT; ++k) {
+        hash = (hash ^ cells[k]) * 16777619u;
+    }
+    return hash;
+}
+
+
+/// @brief Initialises the set locks of both cache levels
+static void initCacheLocks() {
+    for (int set = 0; set < CACHE_SETS; ++set) {
+        pthread_mutex_init(&exactLevel.locks[set], NULL);
+        pthread_mutex_init(&symmetricLevel.locks[set], NULL);
+    }
+}
+
+
+/// @brief Finds elapsed wall-clock time
+/// @return Seconds since an arbitrary point
+static double cacheTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/// @brief Looks up a puzzle in one cache level
+/// @param level Level to search
+/// @param puzzle Packed puzzle, in the form the level is keyed by
+/// @param solution Receives the packed solution on a solved hit
+/// @return -1: not cached; 0: cached as unsolvable; 1: cached with its solution
+static int findCacheEntry(CacheLevel *level, const unsigned char puzzle[CELL_COUNT], unsigned char solution[CELL_COUNT]) {
+    int set = hashCells(puzzle) & (CACHE_SETS - 1);
+    int found = -1;
+    pthread_mutex_lock(&level->locks[set]);
+    for (int way = 0; way < CACHE_WAYS; ++way) {
+        CacheEntry *entry = &level->entries[set][way];
+        if (entry->used && memcmp(entry->puzzle, puzzle, CELL_COUNT) == 0) {
+            entry->lastUse = atomic_fetch_add(&cacheClock, 1) + 1;
+            found = entry->solved;
+            if (found) {
+                memcpy(solution, entry->solution, CELL_COUNT);
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&level->locks[set]);
+    return found;
+}
+
+
+/// @brief Adds a puzzle to one cache level, replacing the least recently used entry of its set
+/// @param level Level to add to
+/// @param puzzle Packed puzzle, in the form the level is keyed by
+/// @param solution Packed solution in the same form; NULL if unsolvable
+static void insertCacheEntry(CacheLevel *level, const unsigned char puzzle[CELL_COUNT], const unsigned char solution[CELL_COUNT]) {
+    int set = hashCells(puzzle) & (CACHE_SETS - 1);
+    int added = 0;
+    pthread_mutex_lock(&level->locks[set]);
+    CacheEntry *entry = &level->entries[set][0];
+    for (int way = 0; way < CACHE_WAYS; ++way) {
+        CacheEntry *candidate = &level->entries[set][way];
+        if (candidate->used && memcmp(candidate->puzzle, puzzle, CELL_COUNT) == 0) {
+            entry = candidate;
+            break;
+        }
+        if (!candidate->used) {
+            entry = candidate;
+            added = 1;
+            break;
+        }
+        if (candidate->lastUse < entry->lastUse) {
+            entry = candidate;
+        }
+    }
+
+    memcpy(entry->puzzle, puzzle, CELL_COUNT);
+    if (solution != NULL) {
+        memcpy(entry->solution, solution, CELL_COUNT);
+    }
+    else {
+        memset(entry->solution, 0, CELL_COUNT);
+    }
+    entry->solved = (solution != NULL);
+    entry->used = 1;
+    entry->lastUse = atomic_fetch_add(&cacheClock, 1) + 1;
+    pthread_mutex_unlock(&level->locks[set]);
+
+    if (added) {
+        pthread_mutex_lock(&cacheStatsLock);
+        solutionCacheStats.entries++;
+        pthread_mutex_unlock(&cacheStatsLock);
+    }
+}
+
+
+/// @brief Packs a grid into one byte per square
+/// @return 1: packed; 0: grid has values outside 0-9
+static int packCells(int grid[GRID_SIZE][GRID_SIZE], unsigned char cells[CELL_COUNT]) {
+    for (int k = 0; k < CELL_COUNT; ++k) {
+        int value = grid[k / GRID_SIZE][k % GRID_SIZE];
+        if (value < 0 || value > GRID_SIZE) {
+            return 0;
+        }
+        cells[k] = value;
+    }
+    return 1;
+}
+
+
+/// @brief Unpacks a grid packed by packCells()
+static void unpackCells(const unsigned char cells[CELL_COUNT], int grid[GRID_SIZE][GRID_SIZE]) {
+    for (int k = 0; k < CELL_COUNT; ++k) {
+        grid[k / GRID_SIZE][k % GRID_SIZE] = cells[k];
+    }
+}
+
+
+/// @brief Counts a lookup and optionally a measured cost
+/// @param hit 1: hit; 0: miss; -1: neither, only record the cost
+/// @param seconds Where to add spent, NULL for none
+/// @param count Counter to increment with seconds
+/// @param spent Seconds to add
+static void recordCacheLookup(int hit, double *seconds, long *count, double spent) {
+    pthread_mutex_lock(&cacheStatsLock);
+    if (hit > 0) {
+        solutionCacheStats.hits++;
+    }
+    else if (hit == 0) {
+        solutionCacheStats.misses++;
+    }
+    if (seconds != NULL) {
+        *seconds += spent;
+        (*count)++;
+    }
+    pthread_mutex_unlock(&cacheStatsLock);
+}
+
+
+/// @brief Decides whether a miss in the exact level should canonicalise and try the symmetric level
+/// @return 1: canonicalising is cheaper than the solves it saves, or not measured enough yet; 0: otherwise
+/// @details canonicalizeGrid() takes tens of microseconds, the propagating engines solve most
+/// \ puzzles faster than that. The symmetric level is only used while the average solve on a miss
+/// \ costs more than the average canonicalisation, e.g. with the backtracking engines.
+static int useSymmetricLevel() {
+    pthread_mutex_lock(&cacheStatsLock);
+    int use = cacheCosts.canonCount < CACHE_COST_SAMPLES || cacheCosts.solveCount == 0 || \
+        cacheCosts.solveSeconds / cacheCosts.solveCount > cacheCosts.canonSeconds / cacheCosts.canonCount;
+    pthread_mutex_unlock(&cacheStatsLock);
+    return use;
+}
+
+
+/// @brief Solves user grid of puzzle, reusing the solution of the same or any symmetric puzzle solved before
+/// @param puzzle Puzzle to solve
+/// @param solver Solver to run on a cache miss
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @details The exact level is keyed by the grid itself, a hit there costs a hash and a copy.
+/// \ Only on a miss there is the grid canonicalised and looked up in the symmetric level, and
+/// \ only while that pays off, see useSymmetricLevel(). Unsolvable puzzles are cached too.
+/// \ User grid is left unchanged if no solution is found.
+/// @note Thread safe, each set of each level has its own lock
+int solveSudokuCached(Puzzle *puzzle, PuzzleSolver solver) {
+    unsigned char key[CELL_COUNT], canonicalKey[CELL_COUNT], cells[CELL_COUNT];
+    int canonical[GRID_SIZE][GRID_SIZE];
+    GridTransform transform;
+
+    pthread_once(&cacheLocksOnce, initCacheLocks);
+    if (!packCells(puzzle->userGrid, key)) {
+        return solver(puzzle);
+    }
+
+    int found = findCacheEntry(&exactLevel, key, cells);
+    if (found >= 0) {
+        recordCacheLookup(1, NULL, NULL, 0);
+        if (found) {
+            unpackCells(cells, puzzle->userGrid);
+        }
+        return found;
+    }
+
+    int symmetric = useSymmetricLevel();
+    if (symmetric) {
+        double start = cacheTime();
+        symmetric = canonicalizeGrid(puzzle->userGrid, canonical, &transform);
+        recordCacheLookup(-1, &cacheCosts.canonSeconds, &cacheCosts.canonCount, cacheTime() - start);
+    }
+    if (symmetric) {
+        packCells(canonical, canonicalKey);
+        found = findCacheEntry(&symmetricLevel, canonicalKey, cells);
+        if (found >= 0) {
+            recordCacheLookup(1, NULL, NULL, 0);
+            if (found) {
+                unpackCells(cells, canonical);
+                applyInverseTransform(&transform, canonical, puzzle->userGrid);
+                packCells(puzzle->userGrid, cells);
+            }
+            insertCacheEntry(&exactLevel, key, found ? cells : NULL);
+            return found;
+        }
+    }
+
+    double start = cacheTime();
+    int solved = solver(puzzle);
+    recordCacheLookup(0, &cacheCosts.solveSeconds, &cacheCosts.solveCount, cacheTime() - start);
+    if (solved) {
+        packCells(puzzle->userGrid, cells);
+    }
+    insertCacheEntry(&exactLevel, key, solved ? cells : NULL);
+    if (symmetric) {
+        if (solved) {
+            applyTransform(&transform, puzzle->userGrid, canonical);
+            packCells(canonical, cells);
+        }
+        insertCacheEntry(&symmetricLevel, canonicalKey, solved ? cells : NULL);
+    }
+    return solved;
+}
+
+
+/// @brief Empties the solution cache and resets its counters and measured costs
+/// @note Not thread safe, no solve may run at the same time
+void clearSolutionCache() {
+    memset(exactLevel.entries, 0, sizeof(exactLevel.entries));
+    memset(symmetricLevel.entries, 0, sizeof(symmetricLevel.entries));
+    memset(&solutionCacheStats, 0, sizeof(solutionCacheStats));
+    memset(&cacheCosts, 0, sizeof(cacheCosts));
+    atomic_store(&cacheClock, 0);
+}
+
+
+/// @brief Reads one level's entries as written by writeCacheLevel()
+/// @param file File positioned at the level's entry count
+/// @param level Level to add to
+/// @param optional 1: a missing count is not an error (files from before the exact level)
+/// @return 1: read; 0: damaged
+static int readCacheLevel(FILE *file, CacheLevel *level, int optional) {
+    int count;
+    if (fread(&count, sizeof(count), 1, file) != 1) {
+        return optional;
+    }
+    if (count < 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        unsigned char puzzle[CELL_COUNT], solution[CELL_COUNT], solved;
+        if (fread(puzzle, CELL_COUNT, 1, file) != 1 || fread(solution, CELL_COUNT, 1, file) != 1 || \
+            fread(&solved, 1, 1, file) != 1) {
+            return 0;
+        }
+        for (int k = 0; k < CELL_COUNT; ++k) {
+            if (puzzle[k] > GRID_SIZE || solution[k] > GRID_SIZE) {
+                return 0;
+            }
+        }
+        insertCacheEntry(level, puzzle, solved ? solution : NULL);
+    }
+    return 1;
+}
+
+
+/// @brief Writes one level's entry count, then its entries
+/// @return 1: written; 0: failed to write
+static int writeCacheLevel(FILE *file, CacheLevel *level) {
+    int count = 0;
+    for (int set = 0; set < CACHE_SETS; ++set) {
+        for (int way = 0; way < CACHE_WAYS; ++way) {
+            count += level->entries[set][way].used;
+        }
+    }
+
+    int ok = fwrite(&count, sizeof(count), 1, file) == 1;
+    for (int set = 0; set < CACHE_SETS && ok; ++set) {
+        for (int way = 0; way < CACHE_WAYS && ok; ++way) {
+            CacheEntry *entry = &level->entries[set][way];
+            if (entry->used) {
+                ok = fwrite(entry->puzzle, CELL_COUNT, 1, file) == 1 && \
+                    fwrite(entry->solution, CELL_COUNT, 1, file) == 1 && \
+                    fwrite(&entry->solved, 1, 1, file) == 1;
+            }
+        }
+    }
+    return ok;
+}
+
+
+/// @brief Loads solution cache entries saved by saveSolutionCache()
+/// @param filename File to read
+/// @return 1: loaded; 0: no file or damaged file, cache is left empty
+/// @note Cache is cleared first
+int loadSolutionCache(const char *filename) {
+    clearSolutionCache();
+    pthread_once(&cacheLocksOnce, initCacheLocks);
+
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    int ok = readCacheLevel(file, &symmetricLevel, 0) && readCacheLevel(file, &exactLevel, 1);
+    fclose(file);
+    if (!ok) {
+        clearSolutionCache();
+    }
+    return ok;
+}
+
+
+/// @brief Saves every solution cache entry to a file
+/// @param filename File to write
+/// @return 1: saved; 0: failed to write
+/// @note Saves the symmetric level, then the exact level, each as an entry count followed by entries
+int saveSolutionCache(const char *filename) {
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL) {
+        return 0;
+    }
+    int ok = writeCacheLevel(file, &symmetricLevel) && writeCacheLevel(file, &exactLevel);
+    ok &= fclose(file) == 0;
+    return ok;
+}
+
+
+/// @brief Turns keeping the solution cache between runs on or off
+/// @param persistent 1: load the entries saved by an earlier run, save them again on exit; 0: do neither
+/// @note Loading replaces the entries cached so far
+void setSolutionCachePersistent(int persistent) {
+    if (persistent && !solutionCachePersistent) {
+        loadSolutionCache(CACHE_FILENAME);
+    }
+    solutionCachePersistent = persistent;
+}
+
+
+/// @brief Saves the solution cache to #CACHE_FILENAME if the user chose to keep it, meant for atexit()
+void persistSolutionCache() {
+    if (solutionCachePersistent && !saveSolutionCache(CACHE_FILENAME)) {
+        fprintf(stderr, "%s\n", translate("ERROR_WRITE_CACHE"));
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file canon.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for canon.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CANON_H
+#define CANON_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+
+
+/// @brief Number of cache sets, must be a power of two
+#define CACHE_SETS 1024
+/// @brief Entries per cache set, the least recently used one is replaced
+#define CACHE_WAYS 4
+/// @brief Canonicalisations timed before their cost may turn the symmetric cache level off
+#define CACHE_COST_SAMPLES 8
+/// @brief Upper bound on partial transforms kept per level while canonicalising
+/// @note Only grids with many symmetries (e.g. nearly empty ones) reach it; they then map
+/// \ to a representative that depends on the input, which costs cache hits but not correctness
+#define CANON_MAX_FRONTIER 2048
+
+
+/// @brief Symmetry transform: optional transposition, row and column permutation, digit relabelling
+/// @details Square (i, j) of the transformed grid holds labels[v], where v is the value at
+/// \ (rows[i], cols[j]) of the source grid, transposed first if transpose is set.
+/// \ Row and column permutations keep bands and stacks together.
+typedef struct GridTransform {
+    /// @brief 1: source grid is transposed before permuting
+    int transpose;
+    /// @brief Source row of each transformed row
+    int rows[GRID_SIZE];
+    /// @brief Source column of each transformed column
+    int cols[GRID_SIZE];
+    /// @brief New digit of each source digit, labels[0] == 0
+    int labels[GRID_SIZE + 1];
+} GridTransform;
+
+
+/// @brief Solver called on a cache miss
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+typedef int (*PuzzleSolver)(Puzzle *puzzle);
+
+
+/// @brief Hit and miss counters of the solution cache
+typedef struct SolutionCacheStats {
+    long hits;
+    long misses;
+    /// @brief Number of filled cache entries, both levels
+    int entries;
+} SolutionCacheStats;
+
+
+extern int solutionCacheEnabled;
+extern int solutionCachePersistent;
+extern SolutionCacheStats solutionCacheStats;
+
+
+void applyTransform(const GridTransform *transform, int grid[GRID_SIZE][GRID_SIZE], int result[GRID_SIZE][GRID_SIZE]);
+void randomGridTransform(GridTransform *transform, RandomStream *random);
+void applyInverseTransform(const GridTransform *transform, int grid[GRID_SIZE][GRID_SIZE], int result[GRID_SIZE][GRID_SIZE]);
+int canonicalizeGrid(int grid[GRID_SIZE][GRID_SIZE], int canonical[GRID_SIZE][GRID_SIZE], GridTransform *transform);
+
+int solveSudokuCached(Puzzle *puzzle, PuzzleSolver solver);
+void clearSolutionCache();
+int loadSolutionCache(const char *filename);
+int saveSolutionCache(const char *filename);
+void setSolutionCachePersistent(int persistent);
+void persistSolutionCache();
+
+
+#endif
@@ -0,0 +1,386 @@
+/**
+ * @file cli.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Headless command-line mode: solve, validate, grade and generate puzzles in pipelines
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./batch.h"
+#include "./grade.h"
+#include "./canon.h"
+#include "./text.h"
+#include "./kernels.h"
+#include "./cli.h"
+#include "./ui.h"
+
+
+/// @brief Subcommands of the command-line mode
+typedef enum CliCommand {
+    /// @brief Print the solution of every puzzle read
+    CLI_COMMAND_SOLVE,
+    /// @brief Print whether every puzzle read has a unique solution
+    CLI_COMMAND_VALIDATE,
+    /// @brief Print the difficulty and rating of every puzzle read
+    CLI_COMMAND_GRADE,
+    /// @brief Print new puzzles
+    CLI_COMMAND_GENERATE,
+    /// @brief Number of commands, not a command
+    CLI_COMMAND_COUNT
+} CliCommand;
+
+
+/// @brief Command names as typed on the command line, in #CliCommand order
+static const char *commandNames[CLI_COMMAND_COUNT] = {"solve", "validate", "grade", "generate"};
+/// @brief Difficulty names printed by grade, in #Difficulty order; output is not translated
+static const char *difficultyNames[DIFFICULTY_COUNT] = {"ungraded", "easy", "medium", "hard", "expert", "invalid"};
+
+
+/// @brief State of one command-line run
+typedef struct CliRun {
+    /// @brief Command being run
+    CliCommand command;
+    /// @brief Worker threads, 0 for every core
+    int threadCount;
+    /// @brief Puzzles read but not processed yet, in input order
+    Puzzle *batch;
+    /// @brief Puzzles in batch
+    int batchCount;
+    /// @brief Rejected lines read just before each puzzle in batch, entry batchCount counts those after the last
+    int *rejectedBefore;
+    /// @brief Per-puzzle results of solve
+    BatchStatus *statuses;
+    /// @brief Per-puzzle results of validate (solution count) and grade (difficulty)
+    int *results;
+    /// @brief Per-puzzle ratings of grade
+    int *ratings;
+    /// @brief Puzzles processed so far
+    long processed;
+    /// @brief Puzzles solved, unique or valid so far
+    long succeeded;
+} CliRun;
+
+
+/// @brief Task of validate: counts solutions of one puzzle, up to two
+/// @return 1: unique solution; 0: otherwise
+static int validateTask(int index, void *context) {
+    CliRun *run = context;
+    run->results[index] = countSolutions(&run->batch[index], 2);
+    return run->results[index] == 1;
+}
+
+
+/// @brief Task of grade: grades one puzzle
+/// @return 1: valid puzzle; 0: no unique solution
+static int gradeTask(int index, void *context) {
+    CliRun *run = context;
+    run->results[index] = gradeGrid(run->batch[index].grid, &run->ratings[index]);
+    return run->results[index] != DIFFICULTY_INVALID;
+}
+
+
+/// @brief Writes "invalid" lines for rejected input lines, so output lines stay aligned with input lines
+static void writeRejected(int count) {
+    for (int i = 0; i < count; ++i) {
+        fputs("invalid\n", stdout);
+    }
+}
+
+
+/// @brief Writes the results of the current batch to stdout, one line per puzzle and rejected line in input order
+static void writeBatch(const CliRun *run) {
+    char line[CELL_COUNT + 1];
+    line[CELL_COUNT] = '\n';
+
+    for (int i = 0; i < run->batchCount; ++i) {
+        writeRejected(run->rejectedBefore[i]);
+        switch (run->command) {
+            case CLI_COMMAND_SOLVE:
+                if (run->statuses[i] == BATCH_STATUS_SOLVED) {
+                    formatPuzzleLine(run->batch[i].userGrid, line);
+                    fwrite(line, 1, sizeof(line), stdout);
+                }
+                else {
+                    fputs("unsolvable\n", stdout);
+                }
+                break;
+            case CLI_COMMAND_VALIDATE:
+                fputs(run->results[i] == 1 ? "unique\n" : run->results[i] > 1 ? "multiple\n" : "unsolvable\n", stdout);
+                break;
+            default:
+                printf("%s %d\n", difficultyNames[run->results[i]], run->ratings[i]);
+        }
+    }
+    writeRejected(run->rejectedBefore[run->batchCount]);
+}
+
+
+/// @brief Processes the puzzles read so far on every worker, then writes their results in order
+static void processBatch(CliRun *run) {
+    if (run->batchCount == 0) {
+        writeRejected(run->rejectedBefore[0]);
+        run->rejectedBefore[0] = 0;
+        return;
+    }
+    switch (run->command) {
+        case CLI_COMMAND_SOLVE:
+            run->succeeded += solvePuzzleBatch(run->batch, run->batchCount, run->statuses, run->threadCount);
+            break;
+        case CLI_COMMAND_VALIDATE:
+            run->succeeded += runBatchTasks(run->batchCount, validateTask, run, run->threadCount);
+            break;
+        default:
+            run->succeeded += runBatchTasks(run->batchCount, gradeTask, run, run->threadCount);
+    }
+    writeBatch(run);
+    run->processed += run->batchCount;
+    memset(run->rejectedBefore, 0, (run->batchCount + 1) * sizeof(int));
+    run->batchCount = 0;
+}
+
+
+/// @brief Handler of streamPuzzleFile(): queues a puzzle, processing the batch once it is full
+static int queuePuzzle(Puzzle *puzzle, void *context) {
+    CliRun *run = context;
+    run->batch[run->batchCount++] = *puzzle;
+    if (run->batchCount == CLI_BATCH_PUZZLES) {
+        processBatch(run);
+    }
+    return 1;
+}
+
+
+/// @brief Handler of streamPuzzleFile() for rejected lines: queues an "invalid" result after the queued puzzles
+static int queueRejected(const char *line, size_t length, void *context) {
+    CliRun *run = context;
+    run->rejectedBefore[run->batchCount]++;
+    return 1;
+}
+
+
+/// @brief Handler of streamPuzzleFile() for 4x4, 16x16 and 25x25 puzzles: writes their result at once
+/// @details The queued 9x9 puzzles are processed first, so results stay in input order.
+/// \ These sizes are solved by the kernels of kernels.c on the calling thread; grade has no
+/// \ grader for them and writes "ungraded 0".
+static int processSizedPuzzle(int *cells, int size, void *context) {
+    CliRun *run = context;
+    char line[TEXT_MAX_SQUARES + 1];
+    processBatch(run);
+
+    switch (run->command) {
+        case CLI_COMMAND_SOLVE:
+            if (solveSizedGrid(cells, size) == 1) {
+                formatSizedLine(cells, size, line);
+                line[size * size] = '\n';
+                fwrite(line, 1, size * size + 1, stdout);
+                run->succeeded++;
+            }
+            else {
+                fputs("unsolvable\n", stdout);
+            }
+            break;
+        case CLI_COMMAND_VALIDATE: {
+            int count = countSizedSolutions(cells, size, 2);
+            fputs(count == 1 ? "unique\n" : count > 1 ? "multiple\n" : "unsolvable\n", stdout);
+            run->succeeded += (count == 1);
+            break;
+        }
+        default:
+            printf("%s 0\n", difficultyNames[DIFFICULTY_UNGRADED]);
+    }
+    run->processed++;
+    return 1;
+}
+
+
+/// @brief Prints command-line usage to stderr
+static void printUsage() {
+    char *keys[] = {"CLI_USAGE_1", "CLI_USAGE_2", "CLI_USAGE_3", "CLI_USAGE_4", "CLI_USAGE_5", \
+        "CLI_USAGE_6", "CLI_USAGE_7", "CLI_USAGE_8", "CLI_USAGE_9", "CLI_USAGE_10", \
+        "CLI_USAGE_11", "CLI_USAGE_12"};
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); ++k) {
+        fprintf(stderr, "%s\n", translate(keys[k]));
+    }
+}
+
+
+/// @brief Finds elapsed wall-clock time, workers run in parallel so CPU time would overstate it
+/// @return Seconds since an arbitrary point
+static double wallTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/// @brief Generates puzzles with a unique solution on every worker and writes them to stdout
+/// @param run Run whose thread count and batch buffer are used
+/// @param count Puzzles to generate
+/// @param clues Clues per puzzle; with minimal, the most clues allowed
+/// @param minimal 1: every clue of every puzzle is needed
+/// @param seed Master seed, the same seed always writes the same puzzles in the same order
+/// @return Puzzles generated
+static long generateToOutput(CliRun *run, long count, int clues, int minimal, unsigned long long seed) {
+    char line[CELL_COUNT + 1];
+    line[CELL_COUNT] = '\n';
+
+    for (long done = 0; done < count; done += run->batchCount) {
+        run->batchCount = (count - done < CLI_BATCH_PUZZLES) ? (int)(count - done) : CLI_BATCH_PUZZLES;
+        generatePuzzleBatch(run->batch, run->batchCount, clues, minimal, seed, done, run->threadCount);
+        for (int i = 0; i < run->batchCount; ++i) {
+            formatPuzzleLine(run->batch[i].grid, line);
+            fwrite(line, 1, sizeof(line), stdout);
+        }
+    }
+    run->batchCount = 0;
+    return count;
+}
+
+
+/// @brief Runs the program without menus, reading puzzles from files or stdin and writing results to stdout
+/// @param argc Argument count of main()
+/// @param argv Arguments of main(): command, options, then input files ("-" or none for stdin)
+/// @return Exit status: 0 on success; 1 on bad usage or unreadable input
+/// @details Input is read in batches of #CLI_BATCH_PUZZLES puzzles; each batch is processed on every
+/// \ worker thread and its results are written in input order before the next batch is read.
+/// \ No launch log, save file or screen clearing is used. The solution cache is off unless -k 1 is
+/// \ given, and is then neither loaded nor saved. A summary goes to stderr.
+int runCommandLine(int argc, char *argv[]) {
+    CliRun run;
+    memset(&run, 0, sizeof(run));
+    run.command = CLI_COMMAND_COUNT;
+    for (int c = 0; c < CLI_COMMAND_COUNT; ++c) {
+        if (strcmp(argv[1], commandNames[c]) == 0) {
+            run.command = c;
+        }
+    }
+
+    long generateCount = 1;
+    int clues = CLI_DEFAULT_CLUES;
+    unsigned long long seed = (unsigned long long)time(NULL);
+    int minimal = 0;
+    int useCache = 0;
+    char *statsFile = NULL;
+    long traceInterval = 0;
+    int firstFile = argc;
+    int valid = (run.command != CLI_COMMAND_COUNT);
+
+    for (int a = 2; valid && a < argc; ++a) {
+        if (argv[a][0] != '-' || argv[a][1] == '\0') {
+            firstFile = a;
+            break;
+        }
+        if (a + 1 >= argc || argv[a][2] != '\0') {
+            valid = 0;
+            break;
+        }
+        char *value = argv[++a];
+        switch (argv[a - 1][1]) {
+            case 't':
+                valid = sscanf(value, "%d", &run.threadCount) == 1 && run.threadCount >= 0;
+                break;
+            case 'n':
+                valid = sscanf(value, "%ld", &generateCount) == 1 && generateCount >= 0;
+                break;
+            case 'c':
+                valid = sscanf(value, "%d", &clues) == 1 && clues >= 17 && clues <= 81;
+                break;
+            case 's':
+                valid = sscanf(value, "%llu", &seed) == 1;
+                break;
+            case 'm':
+                valid = sscanf(value, "%d", &minimal) == 1 && (minimal == 0 || minimal == 1);
+                break;
+            case 'k':
+                valid = sscanf(value, "%d", &useCache) == 1 && (useCache == 0 || useCache == 1);
+                break;
+            case 'j':
+                statsFile = value;
+                break;
+            case 'T':
+                valid = sscanf(value, "%ld", &traceInterval) == 1 && traceInterval > 0;
+                break;
+            case 'e':
+                solverEngine = findSolverEngine(value);
+                valid = solverEngine != SOLVER_ENGINE_COUNT;
+                break;
+            default:
+                valid = 0;
+        }
+    }
+    if (!valid) {
+        printUsage();
+        return 1;
+    }
+
+    static char outputBuffer[TEXT_BUFFER_SIZE];
+    setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    srand((unsigned int)seed);
+    solutionCacheEnabled = useCache;
+    if (traceInterval > 0) {
+        setSolverTrace(stderr, traceInterval);
+    }
+    double start = wallTime();
+    TextImportStats total = {0, 0};
+
+    run.batch = malloc(CLI_BATCH_PUZZLES * sizeof(Puzzle));
+    run.statuses = malloc(CLI_BATCH_PUZZLES * sizeof(BatchStatus));
+    run.results = malloc(CLI_BATCH_PUZZLES * sizeof(int));
+    run.ratings = malloc(CLI_BATCH_PUZZLES * sizeof(int));
+    run.rejectedBefore = calloc(CLI_BATCH_PUZZLES + 1, sizeof(int));
+    if (run.batch == NULL || run.statuses == NULL || run.results == NULL || run.ratings == NULL || \
+        run.rejectedBefore == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    if (run.command == CLI_COMMAND_GENERATE) {
+        run.processed = run.succeeded = generateToOutput(&run, generateCount, clues, minimal, seed);
+    }
+    else {
+        for (int a = firstFile; a < argc || a == firstFile; ++a) {
+            int fromStdin = (a >= argc || strcmp(argv[a], "-") == 0);
+            FILE *file = fromStdin ? stdin : fopen(argv[a], "rb");
+            if (file == NULL) {
+                fflush(stdout);
+                fprintf(stderr, "%s: %s\n", translate("ERROR_OPEN_FILE"), argv[a]);
+                return 1;
+            }
+            TextImportStats stats;
+            PuzzleTextHandlers handlers = {queuePuzzle, processSizedPuzzle, queueRejected};
+            streamPuzzleFile(file, &handlers, &run, &stats);
+            total.accepted += stats.accepted;
+            total.rejected += stats.rejected;
+            if (!fromStdin) {
+                fclose(file);
+            }
+        }
+        processBatch(&run);
+    }
+    free(run.batch);
+    free(run.statuses);
+    free(run.results);
+    free(run.ratings);
+    free(run.rejectedBefore);
+
+    fflush(stdout);
+    double seconds = wallTime() - start;
+    char *succeededKey = run.command == CLI_COMMAND_SOLVE ? "CLI_SUMMARY_SOLVED" : \
+        run.command == CLI_COMMAND_VALIDATE ? "CLI_SUMMARY_UNIQUE" : \
+        run.command == CLI_COMMAND_GRADE ? "CLI_SUMMARY_GRADED" : "CLI_SUMMARY_GENERATED";
+    fprintf(stderr, "%ld %s, %ld %s, %ld %s, %.3fs, %.0f %s\n", run.processed, translate("CLI_SUMMARY_PUZZLES"), \
+        run.succeeded, translate(succeededKey), total.rejected, translate("CLI_SUMMARY_REJECTED"), \
+        seconds, seconds > 0 ? run.processed / seconds : 0.0, translate("CLI_SUMMARY_RATE"));
+
+    if (statsFile != NULL && !exportSolverStats(statsFile)) {
+        fprintf(stderr, "%s: %s\n", translate("ERROR_OPEN_FILE"), statsFile);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file cli.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for cli.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+#include "./dependencies.h"
+
+
+/// @brief Puzzles read before a batch is processed and written out, bounds memory use
+#define CLI_BATCH_PUZZLES 8192
+/// @brief Clues of generated puzzles if -c is not given
+#define CLI_DEFAULT_CLUES 30
+
+
+int runCommandLine(int argc, char *argv[]);
+
+
+#endif
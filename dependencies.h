@@ -22,6 +22,14 @@
 #define BIN_SAVE_FILENAME "save.bin"
 /// @brief Log text file name 
 #define LOG_FILENAME "log.txt"
+/// @brief Binary launch and runtime counters file name
+#define STATS_FILENAME "stats.bin"
+/// @brief The log is replaced by a one-line summary once it is larger than this
+#define LOG_COMPACT_BYTES (64L * 1024)
+/// @brief Solution cache file name
+#define CACHE_FILENAME "cache.bin"
+/// @brief Saves at least this large are memory-mapped and decoded on demand instead of loaded whole
+#define LAZY_LOAD_MIN_BYTES (16L * 1024 * 1024)
 
 
 /// @brief Grid size of Sudoku puzzle (9x9 is standard)
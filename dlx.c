@@ -0,0 +1,255 @@
+/**
+ * @file dlx.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Dancing Links (Algorithm X) exact cover solver
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./dlx.h"
+
+
+/// @brief Matrix reused by every solveSudokuDlx() call on the same thread
+static _Thread_local DlxMatrix dlxMatrix;
+
+
+/// @brief Links a new node at the bottom of a column
+/// @param matrix Matrix to modify
+/// @param node Node to link
+/// @param col Column header index
+static void appendToColumn(DlxMatrix *matrix, int node, int col) {
+    matrix->column[node] = col;
+    matrix->down[node] = col;
+    matrix->up[node] = matrix->up[col];
+    matrix->down[matrix->up[col]] = node;
+    matrix->up[col] = node;
+    matrix->size[col]++;
+}
+
+
+/// @brief Builds the full Sudoku exact cover matrix
+/// @param matrix Matrix to build
+/// @note Only builds once, later calls return immediately
+void initDlxMatrix(DlxMatrix *matrix) {
+    if (matrix->ready) {
+        return;
+    }
+
+    for (int col = 0; col <= DLX_COLUMN_COUNT; ++col) {
+        matrix->left[col] = (col == 0) ? DLX_COLUMN_COUNT : col - 1;
+        matrix->right[col] = (col == DLX_COLUMN_COUNT) ? 0 : col + 1;
+        matrix->up[col] = col;
+        matrix->down[col] = col;
+        matrix->column[col] = col;
+        matrix->size[col] = 0;
+        matrix->covered[col] = 0;
+    }
+
+    int node = DLX_COLUMN_COUNT + 1;
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int i = cell / GRID_SIZE;
+        int j = cell % GRID_SIZE;
+        for (int d = 0; d < GRID_SIZE; ++d) {
+            int candidate = cell * GRID_SIZE + d;
+            int cols[4] = {
+                1 + cell,
+                1 + CELL_COUNT + i * GRID_SIZE + d,
+                1 + 2 * CELL_COUNT + j * GRID_SIZE + d,
+                1 + 3 * CELL_COUNT + boxOfSquare(i, j) * GRID_SIZE + d
+            };
+
+            matrix->rowNode[candidate] = node;
+            for (int k = 0; k < 4; ++k) {
+                appendToColumn(matrix, node + k, cols[k]);
+                matrix->row[node + k] = candidate;
+                matrix->left[node + k] = node + (k + 3) % 4;
+                matrix->right[node + k] = node + (k + 1) % 4;
+            }
+            node += 4;
+        }
+    }
+
+    matrix->ready = 1;
+}
+
+
+/// @brief Removes a column and every row crossing it from the matrix
+/// @param matrix Matrix to modify
+/// @param col Column header index
+static void cover(DlxMatrix *matrix, int col) {
+    matrix->left[matrix->right[col]] = matrix->left[col];
+    matrix->right[matrix->left[col]] = matrix->right[col];
+    for (int i = matrix->down[col]; i != col; i = matrix->down[i]) {
+        for (int j = matrix->right[i]; j != i; j = matrix->right[j]) {
+            matrix->up[matrix->down[j]] = matrix->up[j];
+            matrix->down[matrix->up[j]] = matrix->down[j];
+            matrix->size[matrix->column[j]]--;
+        }
+    }
+}
+
+
+/// @brief Restores a column removed by cover(), must be called in reverse cover order
+/// @param matrix Matrix to modify
+/// @param col Column header index
+static void uncover(DlxMatrix *matrix, int col) {
+    for (int i = matrix->up[col]; i != col; i = matrix->up[i]) {
+        for (int j = matrix->left[i]; j != i; j = matrix->left[j]) {
+            matrix->size[matrix->column[j]]++;
+            matrix->up[matrix->down[j]] = j;
+            matrix->down[matrix->up[j]] = j;
+        }
+    }
+    matrix->left[matrix->right[col]] = col;
+    matrix->right[matrix->left[col]] = col;
+}
+
+
+/// @brief Algorithm X search, always leaves the matrix as it found it
+/// @param matrix Matrix to search
+/// @param depth Number of rows chosen so far
+/// @param limit Stop once this many solutions are found
+/// @param count Solutions found so far, updated by the search
+static void search(DlxMatrix *matrix, int depth, int limit, int *count) {
+    if (matrix->right[0] == 0) {
+        if (*count == 0) {
+            memcpy(matrix->solution, matrix->partial, depth * sizeof(int));
+            matrix->solutionLength = depth;
+        }
+        (*count)++;
+        return;
+    }
+
+    int col = matrix->right[0];
+    for (int c = matrix->right[col]; c != 0; c = matrix->right[c]) {
+        if (matrix->size[c] < matrix->size[col]) {
+            col = c;
+        }
+    }
+    if (matrix->size[col] == 0) {
+        return;
+    }
+
+    cover(matrix, col);
+    for (int r = matrix->down[col]; r != col && *count < limit; r = matrix->down[r]) {
+        matrix->partial[depth] = matrix->row[r];
+        STAT_NODE(matrix->row[r] / GRID_SIZE, matrix->row[r] % GRID_SIZE + 1);
+        for (int j = matrix->right[r]; j != r; j = matrix->right[j]) {
+            cover(matrix, matrix->column[j]);
+        }
+        search(matrix, depth + 1, limit, count);
+        for (int j = matrix->left[r]; j != r; j = matrix->left[j]) {
+            uncover(matrix, matrix->column[j]);
+        }
+        STAT_UNDO();
+    }
+    uncover(matrix, col);
+}
+
+
+/// @brief Selects a candidate row for a clue by covering all of its columns
+/// @param matrix Matrix to modify
+/// @param candidate Candidate row index
+/// @return 1: selected; 0: clue conflicts with an earlier clue
+static int selectClue(DlxMatrix *matrix, int candidate) {
+    int node = matrix->rowNode[candidate];
+    int j = node;
+    do {
+        if (matrix->covered[matrix->column[j]]) {
+            return 0;
+        }
+        j = matrix->right[j];
+    } while (j != node);
+
+    j = node;
+    do {
+        matrix->covered[matrix->column[j]] = 1;
+        cover(matrix, matrix->column[j]);
+        j = matrix->right[j];
+    } while (j != node);
+    return 1;
+}
+
+
+/// @brief Reverts selectClue()
+/// @param matrix Matrix to modify
+/// @param candidate Candidate row index
+static void deselectClue(DlxMatrix *matrix, int candidate) {
+    int node = matrix->rowNode[candidate];
+    int j = matrix->left[node];
+    do {
+        uncover(matrix, matrix->column[j]);
+        matrix->covered[matrix->column[j]] = 0;
+        j = matrix->left[j];
+    } while (j != matrix->left[node]);
+}
+
+
+/// @brief Solves a grid with Dancing Links
+/// @param matrix Matrix to use, built on first use
+/// @param grid Grid with clues, left unchanged
+/// @param limit Stop once this many solutions are found (limit >= 1)
+/// @param solution Where to write the first solution found, can be NULL
+/// @return Number of solutions found, at most limit; 0 if clues contradict each other
+int runDlx(DlxMatrix *matrix, int grid[GRID_SIZE][GRID_SIZE], int limit, int solution[GRID_SIZE][GRID_SIZE]) {
+    int clues[CELL_COUNT];
+    int clueCount = 0;
+    int count = 0;
+
+    initDlxMatrix(matrix);
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int num = grid[cell / GRID_SIZE][cell % GRID_SIZE];
+        if (num <= 0) {
+            continue;
+        }
+        if (num > GRID_SIZE || !selectClue(matrix, cell * GRID_SIZE + num - 1)) {
+            count = -1;
+            break;
+        }
+        clues[clueCount++] = cell * GRID_SIZE + num - 1;
+    }
+
+    if (count == 0) {
+        STAT_PHASE(SOLVER_PHASE_SEARCH);
+        search(matrix, 0, limit, &count);
+        STAT_PHASE(SOLVER_PHASE_STORE);
+    }
+
+    while (clueCount > 0) {
+        deselectClue(matrix, clues[--clueCount]);
+    }
+
+    if (count <= 0) {
+        return 0;
+    }
+
+    if (solution != NULL) {
+        for (int i = 0; i < GRID_SIZE; ++i) {
+            for (int j = 0; j < GRID_SIZE; ++j) {
+                solution[i][j] = grid[i][j];
+            }
+        }
+        for (int k = 0; k < matrix->solutionLength; ++k) {
+            int candidate = matrix->solution[k];
+            int cell = candidate / GRID_SIZE;
+            solution[cell / GRID_SIZE][cell % GRID_SIZE] = candidate % GRID_SIZE + 1;
+        }
+    }
+    return count;
+}
+
+
+/// @brief Solves user grid of puzzle using Dancing Links
+/// @param puzzle Puzzle to solve
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @note User grid is left unchanged if no solution is found
+int solveSudokuDlx(Puzzle *puzzle) {
+    return runDlx(&dlxMatrix, puzzle->userGrid, 1, puzzle->userGrid) > 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file dlx.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for dlx.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DLX_H
+#define DLX_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+
+
+/// @brief Exact cover constraints: square filled, digit in row, digit in column, digit in subgrid
+#define DLX_COLUMN_COUNT (4 * CELL_COUNT)
+/// @brief Exact cover candidates: every digit in every square
+#define DLX_ROW_COUNT (GRID_SIZE * CELL_COUNT)
+/// @brief Root + column headers + four nodes per candidate row
+#define DLX_NODE_COUNT (1 + DLX_COLUMN_COUNT + 4 * DLX_ROW_COUNT)
+
+
+/// @brief Dancing Links matrix for Sudoku modelled as an exact cover problem
+/// @details Nodes are preallocated indices instead of pointers. Index 0 is the root,
+/// \ 1..DLX_COLUMN_COUNT are column headers, the rest are candidate row nodes.
+/// \ The matrix is built once and every solve restores it, so solving does not allocate.
+typedef struct DlxMatrix {
+    /// @brief Left neighbour of each node
+    int left[DLX_NODE_COUNT];
+    /// @brief Right neighbour of each node
+    int right[DLX_NODE_COUNT];
+    /// @brief Upper neighbour of each node
+    int up[DLX_NODE_COUNT];
+    /// @brief Lower neighbour of each node
+    int down[DLX_NODE_COUNT];
+    /// @brief Column header of each node
+    int column[DLX_NODE_COUNT];
+    /// @brief Candidate row of each node, cell * GRID_SIZE + (digit - 1)
+    int row[DLX_NODE_COUNT];
+    /// @brief Number of nodes left in each column
+    int size[DLX_COLUMN_COUNT + 1];
+    /// @brief First node of each candidate row
+    int rowNode[DLX_ROW_COUNT];
+    /// @brief Set for columns covered by clues of the current solve
+    int covered[DLX_COLUMN_COUNT + 1];
+    /// @brief Candidate rows chosen by the search so far
+    int partial[CELL_COUNT];
+    /// @brief Candidate rows of the first solution found
+    int solution[CELL_COUNT];
+    /// @brief Number of entries in solution
+    int solutionLength;
+    /// @brief Set once the links have been built
+    int ready;
+} DlxMatrix;
+
+
+void initDlxMatrix(DlxMatrix *matrix);
+int runDlx(DlxMatrix *matrix, int grid[GRID_SIZE][GRID_SIZE], int limit, int solution[GRID_SIZE][GRID_SIZE]);
+int solveSudokuDlx(Puzzle *puzzle);
+
+
+#endif
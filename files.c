@@ -9,8 +9,14 @@
  * 
  */
 
+#include <unistd.h>
+
 #include "./dependencies.h"
 #include "./puzzle.h"
+#include "./grade.h"
+#include "./packed.h"
+#include "./lazy.h"
+#include "./files.h"
 #include "./ui.h"
 
 
@@ -27,10 +33,164 @@ long double findCurrentRuntime() {
     return cpuTime;
 }
 
-/// @brief Calculates and appends CPU runtime during this launch to log file 
+/// @brief Counters of finished launches, see loadUsageCounters()
+static UsageCounters usageCounters;
+/// @brief Set once usageCounters has been read or rebuilt
+static int usageCountersReady = 0;
+/// @brief 1: launches and runtimes are also appended to the text log, which is compacted once it grows
+int eventLogEnabled = 1;
+
+
+/// @brief Encodes usage counters as the bytes of the counters file
+/// @param counters Counters to encode
+/// @param bytes Buffer of #STATS_FILE_SIZE bytes
+/// @details Layout: magic, version, launch count, runtime in microseconds, first and last
+/// \ launch time, then the CRC-32 of everything before it. All fields are little-endian.
+void encodeUsageCounters(const UsageCounters *counters, unsigned char *bytes) {
+    memcpy(bytes, STATS_MAGIC, 4);
+    putLittleEndian(bytes + 4, STATS_FORMAT_VERSION, 4);
+    putLittleEndian(bytes + 8, counters->launchCount, 8);
+    putLittleEndian(bytes + 16, (unsigned long long)(counters->totalRuntime * 1e6 + 0.5), 8);
+    putLittleEndian(bytes + 24, (unsigned long long)counters->firstLaunch, 8);
+    putLittleEndian(bytes + 32, (unsigned long long)counters->lastLaunch, 8);
+    putLittleEndian(bytes + 40, saveChecksum(bytes, STATS_FILE_SIZE - 4), 4);
+}
+
+
+/// @brief Decodes the bytes of a counters file
+/// @param bytes Buffer of #STATS_FILE_SIZE bytes
+/// @param counters Counters to fill, only valid if the bytes are accepted
+/// @return 1: decoded; 0: wrong magic, unknown version or checksum mismatch
+int decodeUsageCounters(const unsigned char *bytes, UsageCounters *counters) {
+    if (memcmp(bytes, STATS_MAGIC, 4) != 0 || getLittleEndian(bytes + 4, 4) != STATS_FORMAT_VERSION || \
+        getLittleEndian(bytes + 40, 4) != saveChecksum(bytes, STATS_FILE_SIZE - 4)) {
+        return 0;
+    }
+    counters->launchCount = getLittleEndian(bytes + 8, 8);
+    counters->totalRuntime = getLittleEndian(bytes + 16, 8) / 1e6;
+    counters->firstLaunch = (long long)getLittleEndian(bytes + 24, 8);
+    counters->lastLaunch = (long long)getLittleEndian(bytes + 32, 8);
+    return 1;
+}
+
+
+/// @brief Reads the counters file
+/// @param counters Counters to fill
+/// @return 1: read; 0: missing or damaged
+static int readUsageCounters(UsageCounters *counters) {
+    unsigned char bytes[STATS_FILE_SIZE];
+    FILE *file = fopen(STATS_FILENAME, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    size_t got = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    return got == sizeof(bytes) && decodeUsageCounters(bytes, counters);
+}
+
+
+/// @brief Writes the counters file through a temporary file, so a crash never leaves half a file
+/// @param counters Counters to write
+static void writeUsageCounters(const UsageCounters *counters) {
+    unsigned char bytes[STATS_FILE_SIZE];
+    encodeUsageCounters(counters, bytes);
+
+    FILE *file = fopen(STATS_FILENAME ".tmp", "wb");
+    if (file == NULL) {
+        return;
+    }
+    size_t written = fwrite(bytes, 1, sizeof(bytes), file);
+    if (fclose(file) != 0 || written != sizeof(bytes) || rename(STATS_FILENAME ".tmp", STATS_FILENAME) != 0) {
+        remove(STATS_FILENAME ".tmp");
+    }
+}
+
+
+/// @brief Rebuilds counters from the text log, for installations that only have the log
+/// @param counters Counters to fill, zeroed if there is no log
+/// @details Reads compacted summaries as well as launch and runtime lines. Only runs once,
+/// \ the counters file is used from then on.
+static void rebuildUsageCounters(UsageCounters *counters) {
+    char line[BUFFER_SIZE];
+    unsigned long long launches = 0;
+    long double runtime = 0.0;
+
+    memset(counters, 0, sizeof(*counters));
+    FILE *file = fopen(LOG_FILENAME, "r");
+    if (file == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "Log summary: %llu launches, %Lf s CPU runtime", &launches, &runtime) == 2) {
+            counters->launchCount += launches;
+            counters->totalRuntime += runtime;
+        }
+        else if (sscanf(line, "Program CPU runtime: %Lf\n", &runtime) == 1) {
+            counters->totalRuntime += runtime;
+        }
+        else if (strncmp(line, "Program launched at:", 20) == 0) {
+            counters->launchCount++;
+        }
+    }
+    fclose(file);
+}
+
+
+/// @brief Loads the counters of finished launches on first use
+/// @param reload 1: read the file again, another launch may have updated it
+/// @return Counters, owned by this module
+static UsageCounters *loadUsageCounters(int reload) {
+    if (!usageCountersReady || reload) {
+        if (!readUsageCounters(&usageCounters)) {
+            rebuildUsageCounters(&usageCounters);
+        }
+        usageCountersReady = 1;
+    }
+    return &usageCounters;
+}
+
+
+/// @brief Replaces the text log with a one-line summary once it is larger than #LOG_COMPACT_BYTES
+/// @param counters Counters the summary is written from
+static void compactEventLog(const UsageCounters *counters) {
+    FILE *file = fopen(LOG_FILENAME, "r");
+    if (file == NULL) {
+        return;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    if (size <= LOG_COMPACT_BYTES) {
+        return;
+    }
+
+    file = fopen(LOG_FILENAME ".tmp", "w");
+    if (file == NULL) {
+        return;
+    }
+    char buf[BUFFER_SIZE];
+    time_t now = time(NULL);
+    strftime(buf, sizeof(buf), "%c", localtime(&now));
+    fprintf(file, "Log summary: %llu launches, %f s CPU runtime, compacted at: %s\n", \
+        counters->launchCount, counters->totalRuntime, buf);
+    if (fclose(file) != 0 || rename(LOG_FILENAME ".tmp", LOG_FILENAME) != 0) {
+        remove(LOG_FILENAME ".tmp");
+    }
+}
+
+
+/// @brief Adds the CPU runtime of this launch to the counters file, and to the log if #eventLogEnabled
 void logRuntime() {
     long double cpuTime = findCurrentRuntime();
 
+    UsageCounters *counters = loadUsageCounters(1);
+    counters->totalRuntime += cpuTime;
+    writeUsageCounters(counters);
+    startTime = clock();  // counted now, keeps a later call from adding it again
+
+    if (!eventLogEnabled) {
+        return;
+    }
     FILE *file = fopen(LOG_FILENAME, "a+");
     if (file == NULL) {
         printf("FAILED OPENING FILE\n");
@@ -41,15 +201,30 @@ void logRuntime() {
     fclose(file);
 }
 
-/// @brief Appends launch date and time to log file
+/// @brief Counts this launch in the counters file, and appends its date and time to the log if #eventLogEnabled
+/// @details The log is compacted here, so it stays small however many launches there are
 void logLaunch() {
+    time_t now = time(NULL);
+    UsageCounters *counters = loadUsageCounters(1);
+    if (eventLogEnabled) {
+        compactEventLog(counters);  // before counting this launch, its own line follows the summary
+    }
+    if (counters->launchCount == 0) {
+        counters->firstLaunch = now;
+    }
+    counters->launchCount++;
+    counters->lastLaunch = now;
+    writeUsageCounters(counters);
+
+    if (!eventLogEnabled) {
+        return;
+    }
     FILE *file = fopen(LOG_FILENAME, "a+");
     if (file == NULL) {
         printf("FAILED OPENING FILE\n");
         return;
     }
 
-    time_t now = time(NULL);
     struct tm *t = localtime(&now);
 
     char buf[BUFFER_SIZE];
@@ -59,108 +234,383 @@ void logLaunch() {
     fclose(file);
 }
 
-/// @brief Calculates total CPU runtime from log and the current launch
+/// @brief Calculates total CPU runtime of finished launches and the current launch
 /// @return Total CPU runtime in seconds
+/// @note Reads the counters kept in memory, the log is not scanned
 long double readTotalRuntime() {
-    long double totalRuntime = 0.0, previousRuntime = 0.0;
-    char line[BUFFER_SIZE];
+    return loadUsageCounters(0)->totalRuntime + findCurrentRuntime();
+}
 
-    FILE *file = fopen(LOG_FILENAME, "r");
-    if (file == NULL) {
-        printf("Error opening file!\n");
-        return -1.0;
-    }
+/// @brief Reads total launch count
+/// @return Count of total launches by program, including this one
+/// @note Reads the counters kept in memory, the log is not scanned
+int readLaunchCount() {
+    return (int)loadUsageCounters(0)->launchCount;
+}
 
-    while (fgets(line, sizeof(line), file) != NULL) {
-        if (sscanf(line, "Program CPU runtime: %Lf\n", &previousRuntime) == 1) {
-            totalRuntime += previousRuntime;
+
+
+/// @brief Size of a puzzle record in saves before the container format: grid, user grid and bitmap as ints
+#define LEGACY_RECORD_SIZE (3 * sizeof(int) * GRID_SIZE * GRID_SIZE)
+
+
+/// @brief CRC-32 lookup table, built on first use
+static unsigned int crcTable[256];
+static int crcReady = 0;
+
+
+/// @brief Computes the CRC-32 (IEEE) of a buffer
+/// @param data Bytes to check
+/// @param length Number of bytes
+/// @return Checksum
+unsigned int saveChecksum(const unsigned char *data, size_t length) {
+    if (!crcReady) {
+        for (unsigned int n = 0; n < 256; ++n) {
+            unsigned int c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            crcTable[n] = c;
         }
+        crcReady = 1;
     }
 
-    totalRuntime += findCurrentRuntime();
+    unsigned int crc = 0xFFFFFFFFu;
+    for (size_t k = 0; k < length; ++k) {
+        crc = crcTable[(crc ^ data[k]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
 
-    fclose(file);
 
-    return totalRuntime;
+/// @brief Writes an unsigned integer as little-endian bytes
+void putLittleEndian(unsigned char *bytes, unsigned long long value, int size) {
+    for (int k = 0; k < size; ++k) {
+        bytes[k] = (value >> (8 * k)) & 0xFF;
+    }
 }
 
-/// @brief Reads total launch count from log file
-/// @return Count of total launches by program
-int readLaunchCount() {
-    int launchCount = 0;
-    char line[BUFFER_SIZE];
 
-    FILE *file = fopen(LOG_FILENAME, "r");
+/// @brief Reads an unsigned integer from little-endian bytes
+unsigned long long getLittleEndian(const unsigned char *bytes, int size) {
+    unsigned long long value = 0;
+    for (int k = 0; k < size; ++k) {
+        value |= (unsigned long long)bytes[k] << (8 * k);
+    }
+    return value;
+}
+
+
+/// @brief Encodes the stored fields of a puzzle as a save record
+/// @param puzzle Puzzle to encode
+/// @param record Buffer of #SAVE_RECORD_SIZE bytes
+void encodeSaveRecord(const Puzzle *puzzle, unsigned char *record) {
+    PackedPuzzle packed;
+    packPuzzle(puzzle, &packed);
+    memcpy(record, &packed, sizeof(packed));
+    record += sizeof(packed);
+
+    record[0] = (unsigned char)puzzle->difficulty;
+    putLittleEndian(record + 1, (unsigned int)puzzle->rating, 4);
+    putLittleEndian(record + 5, (unsigned long long)puzzle->meta.lastModified, 8);
+    putLittleEndian(record + 13, (unsigned int)(puzzle->meta.solveTime * 1000000.0), 4);
+}
+
+
+/// @brief Decodes a save record, derived fields are not rebuilt
+/// @param record Record bytes
+/// @param puzzle Puzzle to fill
+void decodeSaveRecord(const unsigned char *record, Puzzle *puzzle) {
+    PackedPuzzle packed;
+    memcpy(&packed, record, sizeof(packed));
+    unpackPuzzle(&packed, puzzle);
+    record += sizeof(packed);
+
+    memset(&puzzle->meta, 0, sizeof(puzzle->meta));
+    puzzle->difficulty = record[0] < DIFFICULTY_COUNT ? record[0] : DIFFICULTY_UNGRADED;
+    puzzle->rating = (int)getLittleEndian(record + 1, 4);
+    puzzle->meta.lastModified = (time_t)getLittleEndian(record + 5, 8);
+    puzzle->meta.solveTime = getLittleEndian(record + 13, 4) / 1000000.0;
+}
+
+
+/// @brief Gives up a save: closes and removes the temporary file, prints an error and exits
+/// @param file Temporary file, NULL if already closed
+/// @param tempName Temporary file name
+/// @param key Error message key
+static void abandonSaveFile(FILE *file, const char *tempName, char *key) {
+    if (file != NULL) {
+        fclose(file);
+    }
+    remove(tempName);
+    fprintf(stderr, "%s", translate(key));
+    exit(1);
+}
+
+/// @brief Writes a container format save file
+/// @param filename File to write
+/// @param puzzleCount Number of records
+/// @param source Called once per record, in order, to fill its #SAVE_RECORD_SIZE bytes
+/// @param context Passed to source
+/// @details Writes a #SAVE_HEADER_SIZE byte header (magic, version, record size, count, block size,
+/// \ header CRC-32), then blocks of #SAVE_BLOCK_RECORDS fixed-size records, each block followed
+/// \ by its CRC-32. Every integer is little-endian.
+/// \ The file is written as filename + #SAVE_TEMP_SUFFIX, synced and renamed over filename, so a failed
+/// \ write or a crash during the save leaves the previous file intact.
+void writeSaveFile(const char *filename, int puzzleCount, SaveRecordSource source, void *context) {
+    char tempName[BUFFER_SIZE];
+    snprintf(tempName, sizeof(tempName), "%s" SAVE_TEMP_SUFFIX, filename);
+    FILE *file = fopen(tempName, "wb");
     if (file == NULL) {
-        printf("Error opening file!\n");
-        return -1;
+        fprintf(stderr, "%s", translate("ERROR_OPEN_FILE"));
+        exit(1);
     }
 
-    while (fgets(line, sizeof(line), file) != NULL) {
-        if (strncmp(line, "Program launched at:", 20) == 0) {
-            launchCount++;
-        }
+    unsigned char header[SAVE_HEADER_SIZE] = {0};
+    memcpy(header, SAVE_MAGIC, 4);
+    putLittleEndian(header + 4, SAVE_FORMAT_VERSION, 2);
+    putLittleEndian(header + 6, SAVE_RECORD_SIZE, 2);
+    putLittleEndian(header + 8, (unsigned long long)puzzleCount, 8);
+    putLittleEndian(header + 16, SAVE_BLOCK_RECORDS, 4);
+    putLittleEndian(header + 28, saveChecksum(header, 28), 4);
+    if (fwrite(header, SAVE_HEADER_SIZE, 1, file) != 1) {
+        abandonSaveFile(file, tempName, "ERROR_WRITE_PUZZLECOUNT");
     }
 
-    fclose(file);
+    unsigned char *block = malloc(SAVE_BLOCK_RECORDS * SAVE_RECORD_SIZE + 4);
+    if (block == NULL) {
+        abandonSaveFile(file, tempName, "ERROR_MEMORY_ALLOCATION");
+    }
+    for (int start = 0; start < puzzleCount; start += SAVE_BLOCK_RECORDS) {
+        int count = puzzleCount - start < SAVE_BLOCK_RECORDS ? puzzleCount - start : SAVE_BLOCK_RECORDS;
+        size_t size = count * SAVE_RECORD_SIZE;
+        for (int i = 0; i < count; ++i) {
+            source(start + i, block + i * SAVE_RECORD_SIZE, context);
+        }
+        putLittleEndian(block + size, saveChecksum(block, size), 4);
+        if (fwrite(block, size + 4, 1, file) != 1) {
+            abandonSaveFile(file, tempName, "ERROR_WRITE_PUZZLES");
+        }
+    }
+    free(block);
 
-    return launchCount;
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0) {
+        abandonSaveFile(file, tempName, "ERROR_WRITE_PUZZLES");
+    }
+    if (fclose(file) != 0) {
+        abandonSaveFile(NULL, tempName, "ERROR_WRITE_PUZZLES");
+    }
+    if (rename(tempName, filename) != 0) {
+        abandonSaveFile(NULL, tempName, "ERROR_WRITE_PUZZLES");
+    }
 }
 
-
+/// @brief Record source of saveDataToFile(), encodes the puzzles of an array
+static void encodeArrayRecord(int index, unsigned char *record, void *context) {
+    encodeSaveRecord(&((Puzzle *)context)[index], record);
+}
 
 /// @brief Saves puzzle array and size to .bin file 
 /// @param puzzleArray Array to save
 /// @param puzzleCount Array size to save
-/// @details Change binary file name using #BIN_SAVE_FILENAME macro
-/// @note Saves array size before array!
+/// @details Change binary file name using #BIN_SAVE_FILENAME macro. See writeSaveFile() for the format.
+/// \ While the save is open in lazy mode the loaded array is NULL; only changed records are written
+/// \ back then, see flushLazyStore().
 void saveDataToFile(Puzzle *puzzleArray, int puzzleCount) {
-    FILE *file = fopen(BIN_SAVE_FILENAME, "wb");
+    if (puzzleArray == NULL && lazyStoreActive()) {
+        flushLazyStore(BIN_SAVE_FILENAME);
+        return;
+    }
+    writeSaveFile(BIN_SAVE_FILENAME, puzzleCount, encodeArrayRecord, puzzleArray);
+}
+
+/// @brief Loads a save written before the container format: int count, then int-grid records
+/// @param file File positioned at the start
+/// @param puzzleArray Array to load to
+/// @param puzzleCount Where to save array size
+/// @return 1: every record loaded; 0: damaged or truncated file, only the whole records before the damage were loaded
+static int loadLegacySave(FILE *file, PuzzleArray *puzzleArray, int *puzzleCount) {
+    int count;
+    *puzzleCount = 0;
+    if (fread(&count, sizeof(count), 1, file) != 1 || count < 0) {
+        *puzzleArray = allocatePuzzleArray(0);
+        return 0;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long dataSize = ftell(file) - (long)sizeof(count);
+    fseek(file, sizeof(count), SEEK_SET);
+    int intact = (dataSize == (long)count * (long)LEGACY_RECORD_SIZE);
+    long available = dataSize / (long)LEGACY_RECORD_SIZE;
+    if (count > available) {
+        count = (int)available;
+    }
+
+    *puzzleArray = allocatePuzzleArray(count);
+
+    for (int i = 0; i < count; ++i) {
+        Puzzle *puzzle = &(*puzzleArray)[i];
+        int map[GRID_SIZE][GRID_SIZE];
+        if (fread(puzzle->grid, sizeof(puzzle->grid), 1, file) != 1 || \
+            fread(puzzle->userGrid, sizeof(puzzle->userGrid), 1, file) != 1 || \
+            fread(map, sizeof(map), 1, file) != 1) {
+            return 0;
+        }
+        for (int row = 0; row < GRID_SIZE; ++row) {
+            for (int col = 0; col < GRID_SIZE; ++col) {
+                puzzle->map[row][col] = (map[row][col] == 1);
+            }
+        }
+        memset(&puzzle->meta, 0, sizeof(puzzle->meta));
+        gradePuzzle(puzzle);
+        *puzzleCount = i + 1;
+    }
+    return intact;
+}
+
+/// @brief Loads records of a container format save, block by block
+/// @param file File positioned after the header
+/// @param header Header bytes, already checked
+/// @param puzzleArray Array to load to
+/// @param puzzleCount Where to save array size
+/// @return 1: every block loaded; 0: damaged block found, only puzzles before it were loaded
+static int loadContainerSave(FILE *file, const unsigned char *header, PuzzleArray *puzzleArray, int *puzzleCount) {
+    size_t recordSize = getLittleEndian(header + 6, 2);
+    unsigned long long count = getLittleEndian(header + 8, 8);
+    size_t blockRecords = getLittleEndian(header + 16, 4);
+
+    // never allocate for more records than the file can hold
+    long dataStart = ftell(file);
+    fseek(file, 0, SEEK_END);
+    unsigned long long available = (ftell(file) - dataStart) / recordSize;
+    fseek(file, dataStart, SEEK_SET);
+    int intact = (available >= count);
+    if (count > available) {
+        count = available;
+    }
+    if (count > SAVE_MAX_PUZZLES) {
+        count = SAVE_MAX_PUZZLES;
+        intact = 0;
+    }
+
+    *puzzleCount = 0;
+    *puzzleArray = allocatePuzzleArray((int)count);
+    unsigned char *block = malloc(blockRecords * recordSize + 4);
+    if (block == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    while ((unsigned long long)*puzzleCount < count) {
+        int records = count - *puzzleCount < blockRecords ? (int)(count - *puzzleCount) : (int)blockRecords;
+        size_t size = (size_t)records * recordSize;
+        if (fread(block, size + 4, 1, file) != 1 || saveChecksum(block, size) != getLittleEndian(block + size, 4)) {
+            intact = 0;
+            break;
+        }
+        for (int i = 0; i < records; ++i) {
+            decodeSaveRecord(block + (size_t)i * recordSize, &(*puzzleArray)[*puzzleCount + i]);
+        }
+        *puzzleCount += records;
+    }
+
+    free(block);
+    return intact;
+}
+
+/// @brief Opens a save file and reads its container header, exits if the file cannot be opened
+/// @param filename File to open
+/// @param header Receives #SAVE_HEADER_SIZE header bytes
+/// @param isContainer Receives 1: container format, header checked; 0: older save, file rewound
+/// @return File positioned after the header, or at the start of an older save
+static FILE *openSaveFile(const char *filename, unsigned char *header, int *isContainer) {
+    FILE *file = fopen(filename, "rb");
     if (file == NULL) {
         fprintf(stderr, "%s", translate("ERROR_OPEN_FILE"));
         exit(1);
     }
-    if (fwrite(&puzzleCount, sizeof(puzzleCount), 1, file) != 1) {
-        fprintf(stderr, "%s", translate("ERROR_WRITE_PUZZLECOUNT"));
-        exit(1);
+
+    *isContainer = fread(header, SAVE_HEADER_SIZE, 1, file) == 1 && memcmp(header, SAVE_MAGIC, 4) == 0;
+    if (!*isContainer) {
+        rewind(file);
     }
-    size_t itemsWritten = fwrite(puzzleArray, sizeof(Puzzle), puzzleCount, file);
-    if (itemsWritten != puzzleCount) {
-        fprintf(stderr, "%s", translate("ERROR_WRITE_PUZZLES"));
+    else if (saveChecksum(header, 28) != getLittleEndian(header + 28, 4) || \
+        getLittleEndian(header + 4, 2) != SAVE_FORMAT_VERSION || \
+        getLittleEndian(header + 6, 2) < SAVE_RECORD_SIZE || getLittleEndian(header + 6, 2) > SAVE_MAX_RECORD_SIZE || \
+        getLittleEndian(header + 16, 4) == 0 || getLittleEndian(header + 16, 4) > SAVE_MAX_BLOCK_RECORDS) {
+        fprintf(stderr, "%s", translate("ERROR_READ_PUZZLECOUNT"));
         exit(1);
     }
+    return file;
+}
+
+/// @brief Reads every puzzle of a save file into a new array, in either format
+/// @param filename File to read
+/// @param puzzleArray Receives the array, allocated even if no puzzle could be read
+/// @param puzzleCount Receives array size
+/// @param legacy Receives 1: the file is from before the container format; 0: otherwise; can be NULL
+/// @return 1: every puzzle loaded; 0: damaged or truncated file, only the puzzles before the damage were loaded
+/// @note Play trackers and indexes are not rebuilt, see loadDataFromFile()
+int readSaveFile(const char *filename, PuzzleArray *puzzleArray, int *puzzleCount, int *legacy) {
+    unsigned char header[SAVE_HEADER_SIZE];
+    int isContainer;
+    FILE *file = openSaveFile(filename, header, &isContainer);
+    int intact = isContainer ? loadContainerSave(file, header, puzzleArray, puzzleCount) : \
+        loadLegacySave(file, puzzleArray, puzzleCount);
     fclose(file);
+    if (legacy != NULL) {
+        *legacy = !isContainer;
+    }
+    return intact;
 }
 
 /// @brief Loads puzzle array and size from .bin file, allocates memory
-/// @param puzzleArray Array to load to 
+/// @param puzzleArray Array to load to, the array loaded before (NULL if none) is freed
 /// @param puzzleCount Where to save array size
-/// @details Change binary file name using #BIN_SAVE_FILENAME macro. Loads array size before array.
+/// @details Change binary file name using #BIN_SAVE_FILENAME macro. Reads the container format
+/// \ in one sequential pass, a block at a time, checking every block's CRC-32 before decoding it.
+/// \ A damaged or truncated file keeps the puzzles of every block before the damage.
+/// \ Saves from before the container format are loaded and rewritten in it; a damaged one keeps the
+/// \ puzzles before the damage like a container save and is left as it is until the next save.
+/// \ Rebuilds play trackers, the difficulty index and the puzzle index.
+/// \ Container saves of at least #LAZY_LOAD_MIN_BYTES are opened in lazy mode instead: the file is
+/// \ memory-mapped, the loaded array is NULL and puzzles are decoded on first access through puzzleAt(),
+/// \ see lazy.c. Indexes are then built on first use, see ensurePuzzleIndexes().
+/// \ A lazy mode flush interrupted by a crash is finished or discarded first, see replaySaveJournal().
 void loadDataFromFile(PuzzleArray *puzzleArray, int *puzzleCount) {
-    FILE *file = fopen(BIN_SAVE_FILENAME, "rb");
-    if (file == NULL) {
-        fprintf(stderr, "%s", translate("ERROR_OPEN_FILE"));
-        exit(1);
+    closeLazyStore();
+    freePuzzleArray(*puzzleArray);
+    *puzzleArray = NULL;
+    replaySaveJournal(BIN_SAVE_FILENAME);
+
+    unsigned char header[SAVE_HEADER_SIZE];
+    int isContainer;
+    FILE *file = openSaveFile(BIN_SAVE_FILENAME, header, &isContainer);
+    fseek(file, 0, SEEK_END);
+    int lazy = isContainer && ftell(file) >= LAZY_LOAD_MIN_BYTES && openLazyStore(BIN_SAVE_FILENAME, header);
+    fclose(file);
+    if (lazy) {
+        *puzzleCount = lazyPuzzleCount();
+        invalidatePuzzleIndexes();
+        return;
     }
 
-    if (fread(puzzleCount, sizeof(*puzzleCount), 1, file) != 1) {
-        fprintf(stderr, "%s", translate("ERROR_READ_PUZZLECOUNT"));
-        exit(1);
+    int legacy;
+    int intact = readSaveFile(BIN_SAVE_FILENAME, puzzleArray, puzzleCount, &legacy);
+    if (!intact) {
+        fprintf(stderr, "%s %d\n", translate("ERROR_SAVE_DAMAGED"), *puzzleCount);
     }
 
-    *puzzleArray = malloc(sizeof(Puzzle) * (*puzzleCount));
-    if (*puzzleArray == NULL) {
-        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
-        exit(1);
+    for (int i = 0; i < *puzzleCount; ++i) {
+        rebuildPlayTracker(&(*puzzleArray)[i]);
     }
+    resetPuzzleHandles(*puzzleArray, *puzzleCount);
+    rebuildDifficultyIndex(*puzzleArray, *puzzleCount);
+    rebuildPuzzleIndex(*puzzleArray, *puzzleCount);
 
-    size_t itemsRead = fread(*puzzleArray, sizeof(Puzzle), *puzzleCount, file);
-    if (itemsRead != *puzzleCount) {
-        fprintf(stderr, "%s", translate("ERROR_READ_PUZZLES"));
-        exit(1);
+    if (legacy && intact) {
+        saveDataToFile(*puzzleArray, *puzzleCount);
     }
-
-    fclose(file);
 }
 
 /// @brief Initializes dynamic puzzle array if there is no .bin save file
@@ -15,9 +15,56 @@
 
 #include "puzzle.h"
 #include "./dependencies.h"
+#include "./packed.h"
+
+
+/// @brief First bytes of a container format save file
+#define SAVE_MAGIC "SDKU"
+/// @brief Container format version written by writeSaveFile()
+#define SAVE_FORMAT_VERSION 1
+/// @brief Size of the container header in bytes
+#define SAVE_HEADER_SIZE 32
+/// @brief Appended to the save file name while it is being written, see writeSaveFile()
+#define SAVE_TEMP_SUFFIX ".tmp"
+/// @brief Size of a record written by this version: PackedPuzzle, difficulty, rating, last modified, solve time
+#define SAVE_RECORD_SIZE (sizeof(PackedPuzzle) + 1 + 4 + 8 + 4)
+/// @brief Records per checksummed block
+#define SAVE_BLOCK_RECORDS 4096
+/// @brief Largest record size a save header may give, leaves room for fields of later versions
+#define SAVE_MAX_RECORD_SIZE 1024
+/// @brief Largest block a save header may give, bounds the block buffer of the loaders
+#define SAVE_MAX_BLOCK_RECORDS (16 * SAVE_BLOCK_RECORDS)
+/// @brief Largest puzzle count that fits the int array size
+#define SAVE_MAX_PUZZLES 0x7FFFFFFFull
+
+
+/// @brief First bytes of the counters file
+#define STATS_MAGIC "SDKC"
+/// @brief Counters file version written by encodeUsageCounters()
+#define STATS_FORMAT_VERSION 1
+/// @brief Size of the counters file in bytes
+#define STATS_FILE_SIZE 44
+
+
+/// @brief Totals of every finished launch, kept in #STATS_FILENAME so they are not summed from the log
+typedef struct UsageCounters {
+    /// @brief Launches counted, including a running one once logLaunch() is called
+    unsigned long long launchCount;
+    /// @brief CPU seconds of every launch that called logRuntime()
+    double totalRuntime;
+    /// @brief Time of the first launch counted, 0 if the counters were rebuilt from an existing log
+    long long firstLaunch;
+    /// @brief Time of the last launch counted
+    long long lastLaunch;
+} UsageCounters;
+
+
+/// @brief Fills the bytes of the record with the given index, see writeSaveFile()
+typedef void (*SaveRecordSource)(int index, unsigned char *record, void *context);
 
 
 extern clock_t startTime;
+extern int eventLogEnabled;
 
 
 long double findCurrentRuntime();
@@ -25,8 +72,17 @@ void logRuntime();
 void logLaunch();
 long double readTotalRuntime();
 int readLaunchCount();
+void encodeUsageCounters(const UsageCounters *counters, unsigned char *bytes);
+int decodeUsageCounters(const unsigned char *bytes, UsageCounters *counters);
 
 
+unsigned int saveChecksum(const unsigned char *data, size_t length);
+void putLittleEndian(unsigned char *bytes, unsigned long long value, int size);
+unsigned long long getLittleEndian(const unsigned char *bytes, int size);
+void encodeSaveRecord(const Puzzle *puzzle, unsigned char *record);
+void decodeSaveRecord(const unsigned char *record, Puzzle *puzzle);
+void writeSaveFile(const char *filename, int puzzleCount, SaveRecordSource source, void *context);
+int readSaveFile(const char *filename, PuzzleArray *puzzleArray, int *puzzleCount, int *legacy);
 void saveDataToFile(Puzzle *puzzleArray, int puzzleCount);
 void loadDataFromFile(PuzzleArray *puzzleArray, int *puzzleCount);
 void initDataIfNoBinary(Puzzle *puzzleArray, int puzzleCount);
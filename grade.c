@@ -0,0 +1,495 @@
+/**
+ * @file grade.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Difficulty grading by logical techniques, per-difficulty puzzle index
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./grade.h"
+#include "./ui.h"
+
+
+/// @brief Rating points added each time a technique makes progress
+static const int techniqueWeights[TECHNIQUE_COUNT] = {1, 2, 10, 15, 40};
+/// @brief Rating points added per guess when logic alone gets stuck
+#define SEARCH_TRIAL_WEIGHT 100
+
+/// @brief Result of applying a technique
+#define STEP_CONTRADICTION -1
+#define STEP_NONE 0
+#define STEP_PROGRESS 1
+
+
+/// @brief Index of the puzzles in the loaded puzzle array
+DifficultyIndex difficultyIndex;
+
+
+/// @brief Removes candidate digits from a square
+/// @param state State to modify
+/// @param cell Row-major square index
+/// @param bits Digits to remove
+/// @return STEP_PROGRESS: removed something; STEP_NONE: nothing to remove; STEP_CONTRADICTION: no candidates left
+static int eliminate(PropagationState *state, int cell, unsigned int bits) {
+    if (!(state->candidates[cell] & bits)) {
+        return STEP_NONE;
+    }
+    state->candidates[cell] &= ~bits;
+    return state->candidates[cell] ? STEP_PROGRESS : STEP_CONTRADICTION;
+}
+
+
+/// @brief Fills every square that has a single candidate
+static int applyNakedSingles(PropagationState *state) {
+    int result = STEP_NONE;
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        unsigned int candidates = state->candidates[cell];
+        if (candidates && !(candidates & (candidates - 1))) {
+            if (!assignDigit(state, cell, __builtin_ctz(candidates) + 1)) {
+                return STEP_CONTRADICTION;
+            }
+            result = STEP_PROGRESS;
+        }
+    }
+    return result;
+}
+
+
+/// @brief Fills every digit that fits in only one square of a unit
+static int applyHiddenSingles(PropagationState *state) {
+    int result = STEP_NONE;
+    for (int unit = 0; unit < UNIT_COUNT; ++unit) {
+        unsigned int once = 0, twice = 0, placed = 0;
+        for (int k = 0; k < GRID_SIZE; ++k) {
+            int cell = solverUnits[unit][k];
+            if (state->cells[cell] > 0) {
+                placed |= 1u << (state->cells[cell] - 1);
+            }
+            else {
+                twice |= once & state->candidates[cell];
+                once |= state->candidates[cell];
+            }
+        }
+        if ((once | placed) != ALL_DIGITS_MASK) {
+            return STEP_CONTRADICTION;
+        }
+
+        unsigned int hidden = once & ~twice;
+        while (hidden) {
+            unsigned int bit = hidden & -hidden;
+            hidden &= hidden - 1;
+            for (int k = 0; k < GRID_SIZE; ++k) {
+                int cell = solverUnits[unit][k];
+                if (state->candidates[cell] & bit) {
+                    if (!assignDigit(state, cell, __builtin_ctz(bit) + 1)) {
+                        return STEP_CONTRADICTION;
+                    }
+                    result = STEP_PROGRESS;
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+
+/// @brief Two squares of a unit with the same two candidates remove those from the rest of the unit
+static int applyNakedPairs(PropagationState *state) {
+    int result = STEP_NONE;
+    for (int unit = 0; unit < UNIT_COUNT; ++unit) {
+        for (int a = 0; a < GRID_SIZE; ++a) {
+            unsigned int pair = state->candidates[solverUnits[unit][a]];
+            if (__builtin_popcount(pair) != 2) {
+                continue;
+            }
+            for (int b = a + 1; b < GRID_SIZE; ++b) {
+                if (state->candidates[solverUnits[unit][b]] != pair) {
+                    continue;
+                }
+                for (int k = 0; k < GRID_SIZE; ++k) {
+                    if (k == a || k == b) {
+                        continue;
+                    }
+                    int step = eliminate(state, solverUnits[unit][k], pair);
+                    if (step == STEP_CONTRADICTION) {
+                        return STEP_CONTRADICTION;
+                    }
+                    if (step == STEP_PROGRESS) {
+                        result = STEP_PROGRESS;
+                    }
+                }
+            }
+        }
+        if (result == STEP_PROGRESS) {
+            return result;
+        }
+    }
+    return result;
+}
+
+
+/// @brief Removes a digit from the squares of one unit that are not in another unit
+/// @param state State to modify
+/// @param target Unit to remove the digit from
+/// @param keep Unit whose squares are left alone
+/// @param bit Digit to remove
+static int eliminateOutside(PropagationState *state, int target, int keep, unsigned int bit) {
+    int result = STEP_NONE;
+    for (int k = 0; k < GRID_SIZE; ++k) {
+        int cell = solverUnits[target][k];
+        int inKeep = 0;
+        for (int m = 0; m < GRID_SIZE; ++m) {
+            if (solverUnits[keep][m] == cell) {
+                inKeep = 1;
+                break;
+            }
+        }
+        if (!inKeep) {
+            int step = eliminate(state, cell, bit);
+            if (step == STEP_CONTRADICTION) {
+                return STEP_CONTRADICTION;
+            }
+            if (step == STEP_PROGRESS) {
+                result = STEP_PROGRESS;
+            }
+        }
+    }
+    return result;
+}
+
+
+/// @brief Pointing: digit confined to one line within a subgrid leaves the rest of the line.
+/// \ Claiming: digit confined to one subgrid within a line leaves the rest of the subgrid.
+static int applyLockedCandidates(PropagationState *state) {
+    for (int unit = 0; unit < UNIT_COUNT; ++unit) {
+        int isBox = unit >= 2 * GRID_SIZE;
+        for (int d = 0; d < GRID_SIZE; ++d) {
+            unsigned int bit = 1u << d;
+            unsigned int rows = 0, cols = 0, boxes = 0;
+            for (int k = 0; k < GRID_SIZE; ++k) {
+                int cell = solverUnits[unit][k];
+                if (state->candidates[cell] & bit) {
+                    rows |= 1u << (cell / GRID_SIZE);
+                    cols |= 1u << (cell % GRID_SIZE);
+                    boxes |= 1u << boxOfSquare(cell / GRID_SIZE, cell % GRID_SIZE);
+                }
+            }
+            if (rows == 0) {
+                continue;
+            }
+
+            int step = STEP_NONE;
+            if (isBox && __builtin_popcount(rows) == 1) {
+                step = eliminateOutside(state, __builtin_ctz(rows), unit, bit);
+            }
+            else if (isBox && __builtin_popcount(cols) == 1) {
+                step = eliminateOutside(state, GRID_SIZE + __builtin_ctz(cols), unit, bit);
+            }
+            else if (!isBox && __builtin_popcount(boxes) == 1) {
+                step = eliminateOutside(state, 2 * GRID_SIZE + __builtin_ctz(boxes), unit, bit);
+            }
+            if (step != STEP_NONE) {
+                return step;
+            }
+        }
+    }
+    return STEP_NONE;
+}
+
+
+/// @brief Digit with the same two possible columns in two rows leaves those columns elsewhere,
+/// \ and the same with rows and columns swapped
+static int applyXWing(PropagationState *state) {
+    for (int d = 0; d < GRID_SIZE; ++d) {
+        unsigned int bit = 1u << d;
+        for (int byColumn = 0; byColumn <= 1; ++byColumn) {
+            unsigned int positions[GRID_SIZE];
+            for (int line = 0; line < GRID_SIZE; ++line) {
+                positions[line] = 0;
+                for (int k = 0; k < GRID_SIZE; ++k) {
+                    int cell = byColumn ? k * GRID_SIZE + line : line * GRID_SIZE + k;
+                    if (state->candidates[cell] & bit) {
+                        positions[line] |= 1u << k;
+                    }
+                }
+            }
+
+            for (int a = 0; a < GRID_SIZE; ++a) {
+                if (__builtin_popcount(positions[a]) != 2) {
+                    continue;
+                }
+                for (int b = a + 1; b < GRID_SIZE; ++b) {
+                    if (positions[b] != positions[a]) {
+                        continue;
+                    }
+                    int result = STEP_NONE;
+                    for (int line = 0; line < GRID_SIZE; ++line) {
+                        if (line == a || line == b) {
+                            continue;
+                        }
+                        unsigned int crossing = positions[a];
+                        while (crossing) {
+                            int k = __builtin_ctz(crossing);
+                            crossing &= crossing - 1;
+                            int cell = byColumn ? k * GRID_SIZE + line : line * GRID_SIZE + k;
+                            int step = eliminate(state, cell, bit);
+                            if (step == STEP_CONTRADICTION) {
+                                return STEP_CONTRADICTION;
+                            }
+                            if (step == STEP_PROGRESS) {
+                                result = STEP_PROGRESS;
+                            }
+                        }
+                    }
+                    if (result == STEP_PROGRESS) {
+                        return result;
+                    }
+                }
+            }
+        }
+    }
+    return STEP_NONE;
+}
+
+
+/// @brief Applies one technique once
+/// @param state State to modify
+/// @param technique Technique to apply
+/// @return STEP_PROGRESS, STEP_NONE or STEP_CONTRADICTION
+static int applyTechnique(PropagationState *state, Technique technique) {
+    switch (technique) {
+        case TECHNIQUE_NAKED_SINGLE:
+            return applyNakedSingles(state);
+        case TECHNIQUE_HIDDEN_SINGLE:
+            return applyHiddenSingles(state);
+        case TECHNIQUE_NAKED_PAIR:
+            return applyNakedPairs(state);
+        case TECHNIQUE_LOCKED_CANDIDATES:
+            return applyLockedCandidates(state);
+        case TECHNIQUE_X_WING:
+            return applyXWing(state);
+        default:
+            return STEP_NONE;
+    }
+}
+
+
+/// @brief Counts solutions while counting guesses, used once logic gets stuck
+/// @param state State to search, left in an undefined state
+/// @param limit Stop once this many solutions are found
+/// @param trials Number of guesses made, updated by the search
+/// @return Number of solutions found, at most limit
+static int countTrials(PropagationState *state, int limit, int *trials) {
+    if (!propagate(state)) {
+        return 0;
+    }
+    if (state->emptyCount == 0) {
+        return 1;
+    }
+
+    int count = 0;
+    int cell = findMostConstrainedSquare(state);
+    unsigned int candidates = state->candidates[cell];
+    while (candidates && count < limit) {
+        int num = __builtin_ctz(candidates) + 1;
+        candidates &= candidates - 1;
+
+        PropagationState next = *state;
+        (*trials)++;
+        if (assignDigit(&next, cell, num)) {
+            count += countTrials(&next, limit - count, trials);
+        }
+    }
+    return count;
+}
+
+
+/// @brief Grades a grid by the logical techniques needed to solve it
+/// @param grid Grid with clues, left unchanged
+/// @param rating Receives the difficulty score, can be NULL
+/// @return Difficulty bucket
+/// @details Always applies the easiest technique that makes progress. If logic gets stuck,
+/// \ the rest is solved by search, which also checks that the solution is unique.
+Difficulty gradeGrid(int grid[GRID_SIZE][GRID_SIZE], int *rating) {
+    PropagationState state;
+    int score = 0;
+    int hardest = -1;
+
+    if (rating != NULL) {
+        *rating = 0;
+    }
+    if (!loadPropagationState(&state, grid)) {
+        return DIFFICULTY_INVALID;
+    }
+
+    while (state.emptyCount > 0) {
+        int step = STEP_NONE;
+        int technique;
+        for (technique = 0; technique < TECHNIQUE_COUNT; ++technique) {
+            step = applyTechnique(&state, technique);
+            if (step != STEP_NONE) {
+                break;
+            }
+        }
+        if (step == STEP_CONTRADICTION) {
+            return DIFFICULTY_INVALID;
+        }
+        if (step == STEP_NONE) {
+            break;
+        }
+        score += techniqueWeights[technique];
+        if (technique > hardest) {
+            hardest = technique;
+        }
+    }
+
+    Difficulty difficulty;
+    if (state.emptyCount > 0) {
+        int trials = 0;
+        if (countTrials(&state, 2, &trials) != 1) {
+            return DIFFICULTY_INVALID;
+        }
+        score += trials * SEARCH_TRIAL_WEIGHT;
+        difficulty = DIFFICULTY_EXPERT;
+    }
+    else if (hardest >= TECHNIQUE_X_WING) {
+        difficulty = DIFFICULTY_HARD;
+    }
+    else if (hardest >= TECHNIQUE_NAKED_PAIR) {
+        difficulty = DIFFICULTY_MEDIUM;
+    }
+    else {
+        difficulty = DIFFICULTY_EASY;
+    }
+
+    if (rating != NULL) {
+        *rating = score;
+    }
+    return difficulty;
+}
+
+
+/// @brief Grades the clues (grid) of a puzzle and stores the result in it
+/// @param puzzle Puzzle to grade
+void gradePuzzle(Puzzle *puzzle) {
+    puzzle->difficulty = gradeGrid(puzzle->grid, &puzzle->rating);
+}
+
+
+/// @brief Finds the display string key of a difficulty
+/// @param difficulty Difficulty to name
+/// @return Key to be converted by translate()
+char* difficultyKey(Difficulty difficulty) {
+    switch (difficulty) {
+        case DIFFICULTY_EASY:
+            return "DIFFICULTY_EASY";
+        case DIFFICULTY_MEDIUM:
+            return "DIFFICULTY_MEDIUM";
+        case DIFFICULTY_HARD:
+            return "DIFFICULTY_HARD";
+        case DIFFICULTY_EXPERT:
+            return "DIFFICULTY_EXPERT";
+        case DIFFICULTY_INVALID:
+            return "DIFFICULTY_INVALID";
+        default:
+            return "DIFFICULTY_UNGRADED";
+    }
+}
+
+
+/// @brief Appends a puzzle array index to the bucket of its difficulty
+/// @param puzzleIndex Index in the puzzle array
+/// @param difficulty Difficulty of the puzzle
+void addToDifficultyIndex(int puzzleIndex, Difficulty difficulty) {
+    if (difficulty < 0 || difficulty >= DIFFICULTY_COUNT) {
+        difficulty = DIFFICULTY_UNGRADED;
+    }
+
+    if (difficultyIndex.counts[difficulty] == difficultyIndex.capacities[difficulty]) {
+        int capacity = difficultyIndex.capacities[difficulty] ? 2 * difficultyIndex.capacities[difficulty] : 16;
+        int *bucket = realloc(difficultyIndex.buckets[difficulty], capacity * sizeof(int));
+        if (bucket == NULL) {
+            fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+            exit(1);
+        }
+        difficultyIndex.buckets[difficulty] = bucket;
+        difficultyIndex.capacities[difficulty] = capacity;
+    }
+    if (puzzleIndex >= difficultyIndex.slotCapacity) {
+        int capacity = difficultyIndex.slotCapacity ? 2 * difficultyIndex.slotCapacity : 16;
+        if (capacity <= puzzleIndex) {
+            capacity = puzzleIndex + 1;
+        }
+        int *slots = realloc(difficultyIndex.slots, capacity * sizeof(int));
+        if (slots == NULL) {
+            fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+            exit(1);
+        }
+        difficultyIndex.slots = slots;
+        difficultyIndex.slotCapacity = capacity;
+    }
+
+    difficultyIndex.slots[puzzleIndex] = difficultyIndex.counts[difficulty];
+    difficultyIndex.buckets[difficulty][difficultyIndex.counts[difficulty]++] = puzzleIndex;
+}
+
+
+/// @brief Removes a puzzle array index from the bucket of its difficulty
+/// @param puzzleIndex Index in the puzzle array, must have been added
+/// @param difficulty Difficulty of the puzzle
+/// @note Buckets are unordered, the last entry takes its place
+void removeFromDifficultyIndex(int puzzleIndex, Difficulty difficulty) {
+    if (difficulty < 0 || difficulty >= DIFFICULTY_COUNT) {
+        difficulty = DIFFICULTY_UNGRADED;
+    }
+    int *bucket = difficultyIndex.buckets[difficulty];
+    int slot = difficultyIndex.slots[puzzleIndex];
+    int moved = bucket[--difficultyIndex.counts[difficulty]];
+    bucket[slot] = moved;
+    difficultyIndex.slots[moved] = slot;
+}
+
+
+/// @brief Changes the index of a puzzle that moved in the puzzle array
+/// @param oldIndex Index it had, must have been added
+/// @param newIndex Index it has now, no longer in the index
+/// @param difficulty Difficulty of the puzzle
+void renumberInDifficultyIndex(int oldIndex, int newIndex, Difficulty difficulty) {
+    if (difficulty < 0 || difficulty >= DIFFICULTY_COUNT) {
+        difficulty = DIFFICULTY_UNGRADED;
+    }
+    int slot = difficultyIndex.slots[oldIndex];
+    difficultyIndex.buckets[difficulty][slot] = newIndex;
+    difficultyIndex.slots[newIndex] = slot;
+}
+
+
+/// @brief Rebuilds the difficulty index from the stored ratings of an array, without regrading
+/// @param puzzleArray Array to index
+/// @param puzzleCount Array size
+void rebuildDifficultyIndex(PuzzleArray puzzleArray, int puzzleCount) {
+    for (int d = 0; d < DIFFICULTY_COUNT; ++d) {
+        difficultyIndex.counts[d] = 0;
+    }
+    for (int i = 0; i < puzzleCount; ++i) {
+        addToDifficultyIndex(i, puzzleArray[i].difficulty);
+    }
+}
+
+
+/// @brief Picks a random puzzle of a difficulty
+/// @param difficulty Difficulty to pick from
+/// @return Index in the puzzle array; -1 if there are no puzzles of that difficulty
+int randomPuzzleOfDifficulty(Difficulty difficulty) {
+    if (difficulty < 0 || difficulty >= DIFFICULTY_COUNT || difficultyIndex.counts[difficulty] == 0) {
+        return -1;
+    }
+    return difficultyIndex.buckets[difficulty][rand() % difficultyIndex.counts[difficulty]];
+}
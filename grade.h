@@ -0,0 +1,78 @@
+/**
+ * @file grade.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for grade.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef GRADE_H
+#define GRADE_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+
+
+/// @brief Difficulty buckets, decided by the hardest technique a puzzle needs
+typedef enum Difficulty {
+    /// @brief Not graded yet
+    DIFFICULTY_UNGRADED,
+    /// @brief Naked and hidden singles only
+    DIFFICULTY_EASY,
+    /// @brief Needs naked pairs or locked candidates (pointing, claiming)
+    DIFFICULTY_MEDIUM,
+    /// @brief Needs X-wings
+    DIFFICULTY_HARD,
+    /// @brief Needs trial and error search
+    DIFFICULTY_EXPERT,
+    /// @brief No solution or more than one solution
+    DIFFICULTY_INVALID,
+    /// @brief Number of buckets, not a bucket
+    DIFFICULTY_COUNT
+} Difficulty;
+
+
+/// @brief Solving techniques recognised by the grader, easiest first
+typedef enum Technique {
+    TECHNIQUE_NAKED_SINGLE,
+    TECHNIQUE_HIDDEN_SINGLE,
+    TECHNIQUE_NAKED_PAIR,
+    TECHNIQUE_LOCKED_CANDIDATES,
+    TECHNIQUE_X_WING,
+    /// @brief Number of techniques, not a technique
+    TECHNIQUE_COUNT
+} Technique;
+
+
+/// @brief Lists of puzzle array indices per difficulty, for picking a random puzzle in O(1)
+typedef struct DifficultyIndex {
+    /// @brief Puzzle indices of each bucket
+    int *buckets[DIFFICULTY_COUNT];
+    /// @brief Number of indices in each bucket
+    int counts[DIFFICULTY_COUNT];
+    /// @brief Allocated size of each bucket
+    int capacities[DIFFICULTY_COUNT];
+    /// @brief Position of each puzzle index in its bucket, so entries are removed in O(1)
+    int *slots;
+    /// @brief Allocated size of slots
+    int slotCapacity;
+} DifficultyIndex;
+
+
+extern DifficultyIndex difficultyIndex;
+
+
+Difficulty gradeGrid(int grid[GRID_SIZE][GRID_SIZE], int *rating);
+void gradePuzzle(Puzzle *puzzle);
+char* difficultyKey(Difficulty difficulty);
+void addToDifficultyIndex(int puzzleIndex, Difficulty difficulty);
+void removeFromDifficultyIndex(int puzzleIndex, Difficulty difficulty);
+void renumberInDifficultyIndex(int oldIndex, int newIndex, Difficulty difficulty);
+void rebuildDifficultyIndex(PuzzleArray puzzleArray, int puzzleCount);
+int randomPuzzleOfDifficulty(Difficulty difficulty);
+
+
+#endif
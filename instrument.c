@@ -0,0 +1,158 @@
+/**
+ * @file instrument.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Solver work counters, per call and per process, with JSON export and a sampled search trace
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <pthread.h>
+
+#include "./dependencies.h"
+#include "./instrument.h"
+
+
+/// @brief Counters of the solve running on (or last finished by) the calling thread
+_Thread_local SolverStats solverStats;
+/// @brief Sampled search nodes are written here as JSON lines, NULL turns the trace off
+FILE *solverTraceFile = NULL;
+/// @brief Every this many nodes of a solve one is written to #solverTraceFile
+long solverTraceInterval = 1;
+
+/// @brief Sum of every finished solve, guarded by processStatsLock
+static SolverStats processStats;
+/// @brief Guards processStats, solves end on every batch worker
+static pthread_mutex_t processStatsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Phase names used in JSON, in #SolverPhase order
+static const char *phaseNames[SOLVER_PHASE_COUNT] = {"load", "search", "store"};
+
+
+/// @brief Finds elapsed wall-clock time
+/// @return Seconds since an arbitrary point
+static double statsTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/// @brief Resets the calling thread's counters and starts timing the load phase
+void beginSolverStats() {
+    memset(&solverStats, 0, sizeof(solverStats));
+    solverStats.calls = 1;
+    solverStats.phase = SOLVER_PHASE_LOAD;
+    solverStats.phaseStart = statsTime();
+}
+
+
+/// @brief Closes the current phase and adds the calling thread's solve to the process totals
+/// @note solverStats keeps the counters of the call afterwards, until the next beginSolverStats()
+void endSolverStats() {
+    solverStats.phaseSeconds[solverStats.phase] += statsTime() - solverStats.phaseStart;
+    pthread_mutex_lock(&processStatsLock);
+    mergeSolverStats(&processStats, &solverStats);
+    pthread_mutex_unlock(&processStatsLock);
+}
+
+
+/// @brief Closes the current phase of the calling thread's solve and starts timing another
+/// @param phase Phase starting now
+void switchSolverPhase(SolverPhase phase) {
+    double now = statsTime();
+    solverStats.phaseSeconds[solverStats.phase] += now - solverStats.phaseStart;
+    solverStats.phase = phase;
+    solverStats.phaseStart = now;
+}
+
+
+/// @brief Writes the node just counted to #solverTraceFile as one JSON line
+/// @param cell Row-major square
+/// @param num Digit tried
+/// @details Lines of one thread are in search order, lines of several threads may interleave
+void traceSolverNode(int cell, int num) {
+    fprintf(solverTraceFile, "{\"node\":%ld,\"depth\":%d,\"cell\":%d,\"digit\":%d,\"backtracks\":%ld}\n", \
+        solverStats.nodes, solverStats.depth, cell, num, solverStats.backtracks);
+}
+
+
+/// @brief Adds counters together
+/// @param into Counters to add to
+/// @param from Counters to add, maxDepth is combined with the larger value
+void mergeSolverStats(SolverStats *into, const SolverStats *from) {
+    into->calls += from->calls;
+    into->nodes += from->nodes;
+    into->backtracks += from->backtracks;
+    into->propagations += from->propagations;
+    if (from->maxDepth > into->maxDepth) {
+        into->maxDepth = from->maxDepth;
+    }
+    for (int p = 0; p < SOLVER_PHASE_COUNT; ++p) {
+        into->phaseSeconds[p] += from->phaseSeconds[p];
+    }
+}
+
+
+/// @brief Copies the sum of every solve finished so far in this process
+/// @param stats Counters to fill
+void readProcessSolverStats(SolverStats *stats) {
+    pthread_mutex_lock(&processStatsLock);
+    *stats = processStats;
+    pthread_mutex_unlock(&processStatsLock);
+}
+
+
+/// @brief Checks if the program was built with -DSOLVER_INSTRUMENTATION
+/// @return 1: solver work is counted; 0: every counter stays 0
+int solverInstrumentationEnabled() {
+#ifdef SOLVER_INSTRUMENTATION
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+/// @brief Turns the sampled search trace on or off
+/// @param file File to write nodes to, NULL turns the trace off
+/// @param interval Write every this many nodes of a solve, 1 writes every node
+void setSolverTrace(FILE *file, long interval) {
+    solverTraceInterval = (interval > 0) ? interval : 1;
+    solverTraceFile = file;
+}
+
+
+/// @brief Writes counters as one JSON object, without a trailing newline
+/// @param file File to write to
+/// @param stats Counters to write
+void writeSolverStatsJson(FILE *file, const SolverStats *stats) {
+    fprintf(file, "{\"calls\":%ld,\"nodes\":%ld,\"backtracks\":%ld,\"propagations\":%ld,\"max_depth\":%d", \
+        stats->calls, stats->nodes, stats->backtracks, stats->propagations, stats->maxDepth);
+    for (int p = 0; p < SOLVER_PHASE_COUNT; ++p) {
+        fprintf(file, ",\"%s_seconds\":%.9f", phaseNames[p], stats->phaseSeconds[p]);
+    }
+    fputc('}', file);
+}
+
+
+/// @brief Writes the process totals and the calling thread's last solve to a JSON file
+/// @param filename File to write, replaced if it exists
+/// @return 1: written; 0: file could not be written
+int exportSolverStats(const char *filename) {
+    SolverStats process;
+    readProcessSolverStats(&process);
+
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    fprintf(file, "{\"instrumentation\":%s,\"process\":", solverInstrumentationEnabled() ? "true" : "false");
+    writeSolverStatsJson(file, &process);
+    fprintf(file, ",\"last_call\":");
+    writeSolverStatsJson(file, &solverStats);
+    fprintf(file, "}\n");
+    return fclose(file) == 0;
+}
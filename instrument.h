@@ -0,0 +1,111 @@
+/**
+ * @file instrument.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for instrument.c, counting macros used by the solvers
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details Solver work is only counted if the program is built with -DSOLVER_INSTRUMENTATION.
+ * \ Otherwise every STAT_ macro expands to nothing and the search loops are unchanged; the
+ * \ functions below still exist and report zeros, so callers need no #ifdef of their own.
+ */
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include "./dependencies.h"
+
+
+/// @brief Parts of a solve timed separately
+typedef enum SolverPhase {
+    /// @brief Building the search state from the grid, including propagating the clues
+    SOLVER_PHASE_LOAD,
+    /// @brief Searching for a solution
+    SOLVER_PHASE_SEARCH,
+    /// @brief Writing the solution back to the grid
+    SOLVER_PHASE_STORE,
+    /// @brief Number of phases, not a phase
+    SOLVER_PHASE_COUNT
+} SolverPhase;
+
+
+/// @brief Work done by the solvers, for one call or summed over many
+typedef struct SolverStats {
+    /// @brief Solves counted
+    long calls;
+    /// @brief Digits tried on a square during a search
+    long nodes;
+    /// @brief Tried digits that were undone to try another one
+    long backtracks;
+    /// @brief Squares filled by propagation (naked and hidden singles) instead of by a guess
+    long propagations;
+    /// @brief Deepest search path, in guesses
+    int maxDepth;
+    /// @brief Wall-clock seconds spent in each phase
+    double phaseSeconds[SOLVER_PHASE_COUNT];
+    /// @brief Guesses on the current search path, only meaningful during a call
+    int depth;
+    /// @brief Phase being timed, only meaningful during a call
+    SolverPhase phase;
+    /// @brief Time the current phase started, only meaningful during a call
+    double phaseStart;
+} SolverStats;
+
+
+extern _Thread_local SolverStats solverStats;
+extern FILE *solverTraceFile;
+extern long solverTraceInterval;
+
+
+void beginSolverStats();
+void endSolverStats();
+void switchSolverPhase(SolverPhase phase);
+void traceSolverNode(int cell, int num);
+void mergeSolverStats(SolverStats *into, const SolverStats *from);
+void readProcessSolverStats(SolverStats *stats);
+int solverInstrumentationEnabled();
+void setSolverTrace(FILE *file, long interval);
+void writeSolverStatsJson(FILE *file, const SolverStats *stats);
+int exportSolverStats(const char *filename);
+
+
+/// @brief Counts a digit tried on a square, one level deeper than its parent
+/// @param cell Row-major square
+/// @param num Digit tried
+static inline void recordSolverNode(int cell, int num) {
+    if (++solverStats.depth > solverStats.maxDepth) {
+        solverStats.maxDepth = solverStats.depth;
+    }
+    solverStats.nodes++;
+    if (solverTraceFile != NULL && solverStats.nodes % solverTraceInterval == 0) {
+        traceSolverNode(cell, num);
+    }
+}
+
+
+#ifdef SOLVER_INSTRUMENTATION
+/// @brief Starts counting a solve on the calling thread
+#define STAT_BEGIN() beginSolverStats()
+/// @brief Ends the solve, adding it to the process totals
+#define STAT_END() endSolverStats()
+/// @brief Closes the current phase and starts timing another
+#define STAT_PHASE(phase) switchSolverPhase(phase)
+/// @brief Counts a digit tried on a square
+#define STAT_NODE(cell, num) recordSolverNode(cell, num)
+/// @brief Counts undoing the last digit tried
+#define STAT_UNDO() (solverStats.depth--, solverStats.backtracks++)
+/// @brief Counts a square filled by propagation
+#define STAT_PROPAGATE() (solverStats.propagations++)
+#else
+#define STAT_BEGIN() ((void)0)
+#define STAT_END() ((void)0)
+#define STAT_PHASE(phase) ((void)0)
+#define STAT_NODE(cell, num) ((void)0)
+#define STAT_UNDO() ((void)0)
+#define STAT_PROPAGATE() ((void)0)
+#endif
+
+
+#endif
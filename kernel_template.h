@@ -0,0 +1,252 @@
+/**
+ * @file kernel_template.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Solver kernel template, stamped out once per grid size by kernels.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details Before including, define:
+ * \ KERNEL_SIZE: grid side length (number of digits),
+ * \ KERNEL_BOX: subgrid side length (KERNEL_BOX * KERNEL_BOX == KERNEL_SIZE),
+ * \ KERNEL_MASK: unsigned type with at least KERNEL_SIZE bits.
+ * \ Every table size, loop bound and mask width is then a compile-time constant.
+ * \ No include guard on purpose.
+ */
+
+#define KERNEL_CONCAT_(name, size) name##size
+#define KERNEL_CONCAT(name, size) KERNEL_CONCAT_(name, size)
+/// @brief Appends the grid size to a name, e.g. KERNEL_NAME(search) -> search16
+#define KERNEL_NAME(name) KERNEL_CONCAT(name, KERNEL_SIZE)
+
+#define KERNEL_CELLS (KERNEL_SIZE * KERNEL_SIZE)
+#define KERNEL_UNITS (3 * KERNEL_SIZE)
+#define KERNEL_PEERS (3 * KERNEL_SIZE - 2 * KERNEL_BOX - 1)
+#define KERNEL_ALL ((KERNEL_MASK)((1ull << KERNEL_SIZE) - 1))
+
+
+/// @brief Propagating search state for one grid size, copied on every branch
+typedef struct KERNEL_NAME(KernelState) {
+    /// @brief Square values in row-major order, 0 == empty
+    unsigned char cells[KERNEL_CELLS];
+    /// @brief Digits that can still be written to each square, 0 for filled squares
+    KERNEL_MASK candidates[KERNEL_CELLS];
+    /// @brief Number of empty squares left
+    int emptyCount;
+} KERNEL_NAME(KernelState);
+
+
+/// @brief Squares of every unit: rows, then columns, then subgrids
+static int KERNEL_NAME(kernelUnits)[KERNEL_UNITS][KERNEL_SIZE];
+/// @brief Squares sharing a unit with each square
+static int KERNEL_NAME(kernelPeers)[KERNEL_CELLS][KERNEL_PEERS];
+/// @brief Set once the tables above have been filled in
+static int KERNEL_NAME(kernelReady) = 0;
+
+
+/// @brief Fills in unit and peer tables
+static void KERNEL_NAME(initKernel)() {
+    if (KERNEL_NAME(kernelReady)) {
+        return;
+    }
+
+    for (int i = 0; i < KERNEL_SIZE; ++i) {
+        for (int j = 0; j < KERNEL_SIZE; ++j) {
+            int row = (i / KERNEL_BOX) * KERNEL_BOX + j / KERNEL_BOX;
+            int col = (i % KERNEL_BOX) * KERNEL_BOX + j % KERNEL_BOX;
+            KERNEL_NAME(kernelUnits)[i][j] = i * KERNEL_SIZE + j;
+            KERNEL_NAME(kernelUnits)[KERNEL_SIZE + i][j] = j * KERNEL_SIZE + i;
+            KERNEL_NAME(kernelUnits)[2 * KERNEL_SIZE + i][j] = row * KERNEL_SIZE + col;
+        }
+    }
+
+    for (int cell = 0; cell < KERNEL_CELLS; ++cell) {
+        int row = cell / KERNEL_SIZE;
+        int col = cell % KERNEL_SIZE;
+        int box = (row / KERNEL_BOX) * KERNEL_BOX + col / KERNEL_BOX;
+        int count = 0;
+        for (int other = 0; other < KERNEL_CELLS; ++other) {
+            int otherRow = other / KERNEL_SIZE;
+            int otherCol = other % KERNEL_SIZE;
+            int otherBox = (otherRow / KERNEL_BOX) * KERNEL_BOX + otherCol / KERNEL_BOX;
+            if (other != cell && (otherRow == row || otherCol == col || otherBox == box)) {
+                KERNEL_NAME(kernelPeers)[cell][count++] = other;
+            }
+        }
+    }
+
+    KERNEL_NAME(kernelReady) = 1;
+}
+
+
+/// @brief Writes digit to an empty square and removes it from its peers' candidates
+/// @return 1: success; 0: some peer was left without candidates
+static int KERNEL_NAME(kernelAssign)(KERNEL_NAME(KernelState) *state, int cell, int num) {
+    KERNEL_MASK bit = (KERNEL_MASK)1 << (num - 1);
+
+    state->cells[cell] = num;
+    state->candidates[cell] = 0;
+    state->emptyCount--;
+
+    for (int i = 0; i < KERNEL_PEERS; ++i) {
+        int peer = KERNEL_NAME(kernelPeers)[cell][i];
+        if (state->candidates[peer] & bit) {
+            state->candidates[peer] &= ~bit;
+            if (state->candidates[peer] == 0) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Applies naked singles and hidden singles until nothing changes
+/// @return 1: no contradiction found; 0: state cannot be solved
+static int KERNEL_NAME(kernelPropagate)(KERNEL_NAME(KernelState) *state) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+
+        for (int cell = 0; cell < KERNEL_CELLS; ++cell) {
+            KERNEL_MASK candidates = state->candidates[cell];
+            if (candidates && !(candidates & (candidates - 1))) {
+                if (!KERNEL_NAME(kernelAssign)(state, cell, __builtin_ctz(candidates) + 1)) {
+                    return 0;
+                }
+                changed = 1;
+            }
+        }
+
+        for (int unit = 0; unit < KERNEL_UNITS; ++unit) {
+            KERNEL_MASK once = 0, twice = 0, placed = 0;
+            for (int k = 0; k < KERNEL_SIZE; ++k) {
+                int cell = KERNEL_NAME(kernelUnits)[unit][k];
+                if (state->cells[cell] > 0) {
+                    placed |= (KERNEL_MASK)1 << (state->cells[cell] - 1);
+                }
+                else {
+                    twice |= once & state->candidates[cell];
+                    once |= state->candidates[cell];
+                }
+            }
+            if ((KERNEL_MASK)(once | placed) != KERNEL_ALL) {
+                return 0;
+            }
+
+            KERNEL_MASK hidden = once & ~twice;
+            while (hidden) {
+                int num = __builtin_ctz(hidden) + 1;
+                KERNEL_MASK bit = hidden & -hidden;
+                hidden &= hidden - 1;
+
+                int target = -1;
+                for (int k = 0; k < KERNEL_SIZE; ++k) {
+                    if (state->candidates[KERNEL_NAME(kernelUnits)[unit][k]] & bit) {
+                        target = KERNEL_NAME(kernelUnits)[unit][k];
+                        break;
+                    }
+                }
+                if (target < 0 || !KERNEL_NAME(kernelAssign)(state, target, num)) {
+                    return 0;
+                }
+                changed = 1;
+            }
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Counts solutions with propagation and minimum remaining values branching
+/// @param state State to search, left in an undefined state
+/// @param limit Stop once this many solutions are found
+/// @param solution Receives the first solution found
+/// @param found Solutions found so far, updated by the search
+static void KERNEL_NAME(kernelSearch)(KERNEL_NAME(KernelState) *state, int limit, \
+    KERNEL_NAME(KernelState) *solution, int *found) {
+    if (!KERNEL_NAME(kernelPropagate)(state)) {
+        return;
+    }
+    if (state->emptyCount == 0) {
+        if (*found == 0) {
+            *solution = *state;
+        }
+        (*found)++;
+        return;
+    }
+
+    int best = -1;
+    int bestCount = KERNEL_SIZE + 1;
+    for (int cell = 0; cell < KERNEL_CELLS; ++cell) {
+        if (state->cells[cell] == 0) {
+            int count = __builtin_popcount(state->candidates[cell]);
+            if (count < bestCount) {
+                best = cell;
+                bestCount = count;
+                if (count <= 2) {
+                    break;
+                }
+            }
+        }
+    }
+
+    KERNEL_MASK candidates = state->candidates[best];
+    while (candidates && *found < limit) {
+        int num = __builtin_ctz(candidates) + 1;
+        candidates &= candidates - 1;
+
+        KERNEL_NAME(KernelState) next = *state;
+        if (KERNEL_NAME(kernelAssign)(&next, best, num)) {
+            KERNEL_NAME(kernelSearch)(&next, limit, solution, found);
+        }
+    }
+}
+
+
+/// @brief Solves or counts solutions of a flat row-major grid of this size
+/// @param grid Grid values, 0 == empty
+/// @param limit Stop once this many solutions are found
+/// @param write 1: overwrite grid with the first solution found
+/// @return Number of solutions found, at most limit; 0 if grid values contradict each other
+static int KERNEL_NAME(runKernel)(int *grid, int limit, int write) {
+    KERNEL_NAME(KernelState) state, solution;
+    int found = 0;
+
+    KERNEL_NAME(initKernel)();
+    for (int cell = 0; cell < KERNEL_CELLS; ++cell) {
+        state.cells[cell] = 0;
+        state.candidates[cell] = KERNEL_ALL;
+    }
+    state.emptyCount = KERNEL_CELLS;
+
+    for (int cell = 0; cell < KERNEL_CELLS; ++cell) {
+        int num = grid[cell];
+        if (num <= 0) {
+            continue;
+        }
+        if (num > KERNEL_SIZE || !(state.candidates[cell] & ((KERNEL_MASK)1 << (num - 1))) || \
+            !KERNEL_NAME(kernelAssign)(&state, cell, num)) {
+            return 0;
+        }
+    }
+
+    KERNEL_NAME(kernelSearch)(&state, limit, &solution, &found);
+
+    if (found > 0 && write) {
+        for (int cell = 0; cell < KERNEL_CELLS; ++cell) {
+            grid[cell] = solution.cells[cell];
+        }
+    }
+    return found;
+}
+
+
+#undef KERNEL_CELLS
+#undef KERNEL_UNITS
+#undef KERNEL_PEERS
+#undef KERNEL_ALL
+#undef KERNEL_SIZE
+#undef KERNEL_BOX
+#undef KERNEL_MASK
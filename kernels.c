@@ -0,0 +1,113 @@
+/**
+ * @file kernels.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Solver kernels specialised for 4x4, 16x16 and 25x25 grids; 9x9 grids use solver.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <stdint.h>
+
+#include "./dependencies.h"
+#include "./solver.h"
+#include "./kernels.h"
+
+
+#define KERNEL_SIZE 4
+#define KERNEL_BOX 2
+#define KERNEL_MASK uint8_t
+#include "./kernel_template.h"
+
+#define KERNEL_SIZE 16
+#define KERNEL_BOX 4
+#define KERNEL_MASK uint16_t
+#include "./kernel_template.h"
+
+#define KERNEL_SIZE 25
+#define KERNEL_BOX 5
+#define KERNEL_MASK uint32_t
+#include "./kernel_template.h"
+
+
+/// @brief Solves or counts solutions of a flat 9x9 grid with the propagating solver of solver.c
+/// @param grid Flat row-major grid, 0 == empty
+/// @param limit Stop once this many solutions are found
+/// @param write 1: overwrite grid with the first solution found
+/// @return Number of solutions found, at most limit; 0 if grid values contradict each other
+static int runStandardGrid(int *grid, int limit, int write) {
+    int square[GRID_SIZE][GRID_SIZE];
+    PropagationState state;
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        if (grid[cell] < 0 || grid[cell] > GRID_SIZE) {
+            return 0;
+        }
+        square[cell / GRID_SIZE][cell % GRID_SIZE] = grid[cell];
+    }
+    if (!loadPropagationState(&state, square)) {
+        return 0;
+    }
+    if (!write) {
+        return countPropagationSolutions(&state, limit);
+    }
+    if (!solvePropagationState(&state)) {
+        return 0;
+    }
+    storePropagationState(&state, square);
+    memcpy(grid, square, sizeof(square));
+    return 1;
+}
+
+
+/// @brief Runs the kernel compiled for a grid size
+/// @param grid Flat row-major grid, size * size values, 0 == empty
+/// @param size Grid side length
+/// @param limit Stop once this many solutions are found
+/// @param write 1: overwrite grid with the first solution found
+/// @return Number of solutions found, at most limit; -1 if there is no kernel for size
+static int dispatchKernel(int *grid, int size, int limit, int write) {
+    switch (size) {
+        case 4:
+            return runKernel4(grid, limit, write);
+        case 9:
+            return runStandardGrid(grid, limit, write);
+        case 16:
+            return runKernel16(grid, limit, write);
+        case 25:
+            return runKernel25(grid, limit, write);
+        default:
+            return -1;
+    }
+}
+
+
+/// @brief Checks if there is a solver kernel for a grid size
+/// @param size Grid side length
+/// @return 1: supported; 0: unsupported
+int isSupportedGridSize(int size) {
+    return size == 4 || size == 9 || size == 16 || size == 25;
+}
+
+
+/// @brief Solves a grid of any supported size
+/// @param grid Flat row-major grid, size * size values, 0 == empty. Overwritten with the solution.
+/// @param size Grid side length (4, 9, 16 or 25)
+/// @return 1: solved; 0: unsolvable, grid unchanged; -1: unsupported size
+int solveSizedGrid(int *grid, int size) {
+    return dispatchKernel(grid, size, 1, 1);
+}
+
+
+/// @brief Counts solutions of a grid of any supported size, up to a limit
+/// @param grid Flat row-major grid, size * size values, 0 == empty. Left unchanged.
+/// @param size Grid side length (4, 9, 16 or 25)
+/// @param limit Stop once this many solutions are found
+/// @return Number of solutions found, at most limit; -1: unsupported size
+int countSizedSolutions(int *grid, int size, int limit) {
+    if (limit <= 0) {
+        return isSupportedGridSize(size) ? 0 : -1;
+    }
+    return dispatchKernel(grid, size, limit, 0);
+}
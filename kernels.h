@@ -0,0 +1,27 @@
+/**
+ * @file kernels.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for kernels.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "./dependencies.h"
+
+
+/// @brief Largest grid side length with a solver kernel
+#define MAX_KERNEL_SIZE 25
+
+
+int isSupportedGridSize(int size);
+int solveSizedGrid(int *grid, int size);
+int countSizedSolutions(int *grid, int size, int limit);
+
+
+#endif
@@ -0,0 +1,694 @@
+/**
+ * @file lazy.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Lazy mode for large saves: memory-mapped records decoded on demand, changes written back
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./files.h"
+#include "./lazy.h"
+#include "./ui.h"
+
+
+/// @brief Checksum state of a block of the mapped file
+enum {
+    /// @brief Not read yet
+    BLOCK_UNCHECKED,
+    /// @brief Checksum matches
+    BLOCK_INTACT,
+    /// @brief Checksum does not match, its records are loaded as empty puzzles
+    BLOCK_DAMAGED
+};
+
+
+/// @brief Entry of the table of materialised puzzles
+typedef struct LazySlot {
+    /// @brief Record number, -1 if the slot is free
+    int record;
+    /// @brief Decoded puzzle, owned by the store
+    Puzzle *puzzle;
+} LazySlot;
+
+
+/// @brief State of the open save file
+/// @details Records are numbered in file order; records appended since the file was mapped get
+/// \ numbers from recordCount up. Puzzle n of the collection is record order[n], or record n while
+/// \ nothing has been deleted (order is NULL then).
+typedef struct LazyStore {
+    /// @brief 1 while a save is open in lazy mode
+    int active;
+    /// @brief Open save file
+    int fd;
+    /// @brief Private read-only mapping of the whole file
+    const unsigned char *mapped;
+    /// @brief Size of the mapping
+    size_t mappedSize;
+    /// @brief Bytes per record in the file
+    size_t recordSize;
+    /// @brief Records per checksummed block in the file
+    int blockRecords;
+    /// @brief Records stored in the file
+    int recordCount;
+    /// @brief Checksum state of every block
+    unsigned char *blockStates;
+    /// @brief Puzzles in the collection
+    int count;
+    /// @brief Number given to the next appended record
+    int nextRecord;
+    /// @brief Record of every puzzle, NULL while it is the identity
+    int *order;
+    /// @brief Allocated size of order
+    int orderCapacity;
+    /// @brief Open addressing table from record number to materialised puzzle
+    LazySlot *slots;
+    /// @brief Table size, a power of two
+    int slotCapacity;
+    /// @brief Occupied slots
+    int slotCount;
+    /// @brief Guards everything above, batch workers materialise puzzles concurrently
+    pthread_mutex_t lock;
+} LazyStore;
+
+
+static LazyStore store = {.fd = -1, .lock = PTHREAD_MUTEX_INITIALIZER};
+
+
+
+/// @brief Finds the file offset of a block
+static size_t blockOffset(int block) {
+    return SAVE_HEADER_SIZE + (size_t)block * (store.blockRecords * store.recordSize + 4);
+}
+
+
+/// @brief Finds the number of records in a block of the file
+static int blockLength(int block) {
+    int remaining = store.recordCount - block * store.blockRecords;
+    return remaining < store.blockRecords ? remaining : store.blockRecords;
+}
+
+
+/// @brief Finds the mapped bytes of a record of the file
+static const unsigned char *mappedRecord(int record) {
+    return store.mapped + blockOffset(record / store.blockRecords) + (size_t)(record % store.blockRecords) * store.recordSize;
+}
+
+
+/// @brief Checks the checksum of a block the first time one of its records is read
+/// @return 1: intact; 0: damaged
+static int checkBlock(int block) {
+    if (store.blockStates[block] == BLOCK_UNCHECKED) {
+        const unsigned char *bytes = store.mapped + blockOffset(block);
+        size_t size = blockLength(block) * store.recordSize;
+        if (saveChecksum(bytes, size) == getLittleEndian(bytes + size, 4)) {
+            store.blockStates[block] = BLOCK_INTACT;
+        }
+        else {
+            store.blockStates[block] = BLOCK_DAMAGED;
+            fprintf(stderr, "%s %d\n", translate("ERROR_SAVE_BLOCK_DAMAGED"), block + 1);
+        }
+    }
+    return store.blockStates[block] == BLOCK_INTACT;
+}
+
+
+/// @brief Finds the record of the nth puzzle
+static int physicalRecord(int n) {
+    return store.order != NULL ? store.order[n] : n;
+}
+
+
+/// @brief Finds the slot of a record, or the free slot it would go to
+static LazySlot *findSlot(LazySlot *slots, int capacity, int record) {
+    unsigned int k = ((unsigned int)record * 2654435761u) & (capacity - 1);
+    while (slots[k].record != -1 && slots[k].record != record) {
+        k = (k + 1) & (capacity - 1);
+    }
+    return &slots[k];
+}
+
+
+/// @brief Allocates an empty slot table
+static LazySlot *allocateSlots(int capacity) {
+    LazySlot *slots = malloc(capacity * sizeof(LazySlot));
+    if (slots == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    for (int k = 0; k < capacity; ++k) {
+        slots[k].record = -1;
+        slots[k].puzzle = NULL;
+    }
+    return slots;
+}
+
+
+/// @brief Adds a materialised puzzle to the table, growing it past half full
+static void insertSlot(int record, Puzzle *puzzle) {
+    if (2 * (store.slotCount + 1) > store.slotCapacity) {
+        int capacity = 2 * store.slotCapacity;
+        LazySlot *slots = allocateSlots(capacity);
+        for (int k = 0; k < store.slotCapacity; ++k) {
+            if (store.slots[k].record != -1) {
+                *findSlot(slots, capacity, store.slots[k].record) = store.slots[k];
+            }
+        }
+        free(store.slots);
+        store.slots = slots;
+        store.slotCapacity = capacity;
+    }
+    LazySlot *slot = findSlot(store.slots, store.slotCapacity, record);
+    slot->record = record;
+    slot->puzzle = puzzle;
+    store.slotCount++;
+}
+
+
+/// @brief Finds the materialised puzzle of a record
+/// @return Puzzle; NULL if it was not materialised
+static Puzzle *materialised(int record) {
+    return findSlot(store.slots, store.slotCapacity, record)->puzzle;
+}
+
+
+/// @brief Decodes a record of the file, rebuilding its play tracker
+/// @note Records of damaged blocks decode to an empty puzzle
+static void decodeRecord(int record, Puzzle *puzzle) {
+    if (checkBlock(record / store.blockRecords)) {
+        decodeSaveRecord(mappedRecord(record), puzzle);
+    }
+    else {
+        memset(puzzle, 0, sizeof(*puzzle));
+    }
+    rebuildPlayTracker(puzzle);
+}
+
+
+/// @brief Writes the current bytes of a record: re-encoded if materialised, copied from the file otherwise
+/// @param record Record number
+/// @param bytes Buffer of size bytes
+/// @param size Record size to write, at least #SAVE_RECORD_SIZE; bytes past what this version encodes
+/// \ are kept from the file, or zero for appended records and records of damaged blocks
+static void recordBytes(int record, unsigned char *bytes, size_t size) {
+    int inFile = record < store.recordCount && checkBlock(record / store.blockRecords);
+    if (inFile) {
+        memcpy(bytes, mappedRecord(record), size < store.recordSize ? size : store.recordSize);
+    }
+    else {
+        memset(bytes, 0, size);
+    }
+
+    Puzzle *puzzle = materialised(record);
+    if (puzzle != NULL) {
+        encodeSaveRecord(puzzle, bytes);
+    }
+    else if (!inFile) {
+        Puzzle empty;
+        memset(&empty, 0, sizeof(empty));
+        encodeSaveRecord(&empty, bytes);
+    }
+}
+
+
+/// @brief Record source of flushLazyStore(), writes the puzzles in collection order
+static void storeRecordSource(int index, unsigned char *record, void *context) {
+    recordBytes(physicalRecord(index), record, SAVE_RECORD_SIZE);
+}
+
+
+/// @brief Maps a save file, replacing the current mapping
+/// @param filename Save file
+/// @param recordSize Bytes per record
+/// @param blockRecords Records per block
+/// @param count Records the header claims, capped to the complete blocks present
+/// @return 1: mapped; 0: unable to open or map the file, state unchanged
+static int mapSaveFile(const char *filename, size_t recordSize, int blockRecords, unsigned long long count) {
+    int fd = open(filename, O_RDWR);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size < SAVE_HEADER_SIZE) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 0;
+    }
+
+    size_t blockBytes = blockRecords * recordSize + 4;
+    size_t dataSize = info.st_size - SAVE_HEADER_SIZE;
+    unsigned long long fullBlocks = dataSize / blockBytes;
+    size_t rest = dataSize % blockBytes;
+    unsigned long long available = fullBlocks * blockRecords + (rest >= 4 ? (rest - 4) / recordSize : 0);
+    if (count > available) {
+        count = fullBlocks * blockRecords;
+        fprintf(stderr, "%s %llu\n", translate("ERROR_SAVE_DAMAGED"), count);
+    }
+    if (count > SAVE_MAX_PUZZLES) {
+        count = SAVE_MAX_PUZZLES;
+    }
+
+    void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+
+    if (store.mapped != NULL) {
+        munmap((void *)store.mapped, store.mappedSize);
+        close(store.fd);
+    }
+    int blocks = (int)((count + blockRecords - 1) / blockRecords);
+    free(store.blockStates);
+    store.blockStates = calloc(blocks > 0 ? blocks : 1, 1);
+    if (store.blockStates == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    store.fd = fd;
+    store.mapped = mapped;
+    store.mappedSize = info.st_size;
+    store.recordSize = recordSize;
+    store.blockRecords = blockRecords;
+    store.recordCount = (int)count;
+    return 1;
+}
+
+
+/// @brief Opens a container format save in lazy mode
+/// @param filename Save file
+/// @param header Its header, already checked by loadDataFromFile()
+/// @return 1: opened; 0: unable to map the file, load it whole instead
+/// @note Closes a save already open in lazy mode
+int openLazyStore(const char *filename, const unsigned char *header) {
+    closeLazyStore();
+
+    pthread_mutex_lock(&store.lock);
+    int opened = mapSaveFile(filename, getLittleEndian(header + 6, 2), (int)getLittleEndian(header + 16, 4), \
+        getLittleEndian(header + 8, 8));
+    if (opened) {
+        store.count = store.recordCount;
+        store.nextRecord = store.recordCount;
+        store.slotCapacity = 64;
+        store.slotCount = 0;
+        store.slots = allocateSlots(store.slotCapacity);
+        store.active = 1;
+    }
+    pthread_mutex_unlock(&store.lock);
+    return opened;
+}
+
+
+/// @brief Closes the save open in lazy mode without writing it, freeing every materialised puzzle
+void closeLazyStore() {
+    pthread_mutex_lock(&store.lock);
+    if (store.active) {
+        for (int k = 0; k < store.slotCapacity; ++k) {
+            free(store.slots[k].puzzle);
+        }
+        free(store.slots);
+        free(store.order);
+        free(store.blockStates);
+        munmap((void *)store.mapped, store.mappedSize);
+        close(store.fd);
+        store.slots = NULL;
+        store.order = NULL;
+        store.blockStates = NULL;
+        store.mapped = NULL;
+        store.fd = -1;
+        store.active = 0;
+    }
+    pthread_mutex_unlock(&store.lock);
+}
+
+
+/// @brief Checks if a save is open in lazy mode
+/// @return 1: open; 0: saves are loaded whole
+int lazyStoreActive() {
+    return store.active;
+}
+
+
+/// @brief Finds the number of puzzles in the collection
+int lazyPuzzleCount() {
+    return store.count;
+}
+
+
+/// @brief Finds the nth puzzle, decoding it from the file on first access
+/// @param n Position in the collection
+/// @param created Set to 1 if the puzzle was decoded by this call, 0 otherwise
+/// @return Puzzle owned by the store, valid until closeLazyStore()
+/// @note Thread safe
+Puzzle *lazyPuzzleAt(int n, int *created) {
+    pthread_mutex_lock(&store.lock);
+    int record = physicalRecord(n);
+    Puzzle *puzzle = materialised(record);
+    *created = (puzzle == NULL);
+    if (puzzle == NULL) {
+        puzzle = malloc(sizeof(Puzzle));
+        if (puzzle == NULL) {
+            fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+            exit(1);
+        }
+        decodeRecord(record, puzzle);
+        insertSlot(record, puzzle);
+    }
+    pthread_mutex_unlock(&store.lock);
+    return puzzle;
+}
+
+
+/// @brief Copies the nth puzzle without materialising it
+/// @param n Position in the collection
+/// @param copy Receives the materialised puzzle, or the puzzle decoded from the file
+/// @return 1: copy is of the materialised puzzle; 0: decoded, its metadata is not derived
+/// @note Thread safe
+int lazyPeekPuzzle(int n, Puzzle *copy) {
+    pthread_mutex_lock(&store.lock);
+    int record = physicalRecord(n);
+    Puzzle *puzzle = materialised(record);
+    if (puzzle != NULL) {
+        *copy = *puzzle;
+    }
+    else {
+        decodeRecord(record, copy);
+    }
+    pthread_mutex_unlock(&store.lock);
+    return puzzle != NULL;
+}
+
+
+/// @brief Appends a copy of a puzzle to the collection
+/// @param puzzle Puzzle to append
+void lazyAppendPuzzle(const Puzzle *puzzle) {
+    pthread_mutex_lock(&store.lock);
+    Puzzle *copy = malloc(sizeof(Puzzle));
+    if (copy == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    *copy = *puzzle;
+
+    int record = store.nextRecord++;
+    insertSlot(record, copy);
+    if (store.order != NULL) {
+        if (store.count == store.orderCapacity) {
+            store.orderCapacity *= 2;
+            store.order = realloc(store.order, store.orderCapacity * sizeof(int));
+            if (store.order == NULL) {
+                fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+                exit(1);
+            }
+        }
+        store.order[store.count] = record;
+    }
+    store.count++;
+    pthread_mutex_unlock(&store.lock);
+}
+
+
+/// @brief Removes the nth puzzle from the collection, the last puzzle takes its position
+/// @param n Position in the collection
+/// @note A materialised copy stays allocated until the next flush or close, pointers to it stay valid
+void lazyDeletePuzzle(int n) {
+    pthread_mutex_lock(&store.lock);
+    if (store.order == NULL) {
+        store.orderCapacity = store.count > 16 ? store.count : 16;
+        store.order = malloc(store.orderCapacity * sizeof(int));
+        if (store.order == NULL) {
+            fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+            exit(1);
+        }
+        for (int i = 0; i < store.count; ++i) {
+            store.order[i] = i;
+        }
+    }
+    store.order[n] = store.order[--store.count];
+    pthread_mutex_unlock(&store.lock);
+}
+
+
+/// @brief Visits every puzzle in order without materialising it
+/// @param visit Called with the materialised puzzle, or a temporary decoded copy
+/// @param context Passed to visit
+/// @note visit must not call other functions of the store
+void forEachLazyPuzzle(LazyVisitor visit, void *context) {
+    Puzzle *scratch = malloc(sizeof(Puzzle));
+    if (scratch == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    pthread_mutex_lock(&store.lock);
+    for (int i = 0; i < store.count; ++i) {
+        int record = physicalRecord(i);
+        Puzzle *puzzle = materialised(record);
+        if (puzzle != NULL) {
+            visit(i, puzzle, 1, context);
+        }
+        else {
+            decodeRecord(record, scratch);
+            visit(i, scratch, 0, context);
+        }
+    }
+    pthread_mutex_unlock(&store.lock);
+    free(scratch);
+}
+
+
+/// @brief Rebuilds a block of the mapped file with every materialised record re-encoded
+/// @param block Block number
+/// @param bytes Buffer of a block and its CRC-32, receives both
+/// @return Size of the block including its CRC-32
+static size_t buildBlock(int block, unsigned char *bytes) {
+    int length = blockLength(block);
+    size_t size = length * store.recordSize;
+    for (int i = 0; i < length; ++i) {
+        recordBytes(block * store.blockRecords + i, bytes + i * store.recordSize, store.recordSize);
+    }
+    putLittleEndian(bytes + size, saveChecksum(bytes, size), 4);
+    return size + 4;
+}
+
+
+/// @brief Writes the changed blocks of the mapped file back in place, through a journal
+/// @param filename Save file, the one the store was opened from
+/// @details Puzzles are changed through plain pointers, so a materialised puzzle counts as dirty when
+/// \ its encoding differs from its mapped record. Only blocks holding a dirty record are rebuilt and
+/// \ checksummed. They are written to a journal next to the save first, which is synced before the
+/// \ save is touched, then copied into place by replaySaveJournal(). A crash before the journal is
+/// \ complete leaves the old save; after, loadDataFromFile() finishes the copy on the next launch.
+static void flushInPlace(const char *filename) {
+    int blocks = (store.recordCount + store.blockRecords - 1) / store.blockRecords;
+    unsigned char *dirty = calloc(blocks > 0 ? blocks : 1, 1);
+    unsigned char *bytes = malloc(store.blockRecords * store.recordSize + 4);
+    if (dirty == NULL || bytes == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    int dirtyCount = 0;
+    for (int k = 0; k < store.slotCapacity; ++k) {
+        int record = store.slots[k].record;
+        if (record != -1 && !dirty[record / store.blockRecords]) {
+            recordBytes(record, bytes, store.recordSize);
+            dirty[record / store.blockRecords] = memcmp(bytes, mappedRecord(record), store.recordSize) != 0 || \
+                !checkBlock(record / store.blockRecords);
+            dirtyCount += dirty[record / store.blockRecords];
+        }
+    }
+    if (dirtyCount == 0) {
+        free(bytes);
+        free(dirty);
+        return;
+    }
+
+    char journalName[BUFFER_SIZE];
+    snprintf(journalName, sizeof(journalName), "%s%s", filename, LAZY_JOURNAL_SUFFIX);
+    FILE *journal = fopen(journalName, "wb");
+    if (journal == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_OPEN_FILE"));
+        exit(1);
+    }
+    unsigned char header[LAZY_JOURNAL_HEADER_SIZE];
+    memcpy(header, LAZY_JOURNAL_MAGIC, 4);
+    putLittleEndian(header + 4, (unsigned int)dirtyCount, 4);
+    putLittleEndian(header + 8, (unsigned long long)store.mappedSize, 8);
+    putLittleEndian(header + 16, saveChecksum(header, 16), 4);
+    int ok = fwrite(header, sizeof(header), 1, journal) == 1;
+
+    // each entry: file offset, length, the block with its CRC-32, then a CRC-32 of all three
+    for (int block = 0; block < blocks && ok; ++block) {
+        if (!dirty[block]) {
+            continue;
+        }
+        unsigned char entry[12];
+        size_t size = buildBlock(block, bytes);
+        putLittleEndian(entry, (unsigned long long)blockOffset(block), 8);
+        putLittleEndian(entry + 8, (unsigned int)size, 4);
+        unsigned char check[4];
+        putLittleEndian(check, saveChecksum(entry, 12) ^ saveChecksum(bytes, size), 4);
+        ok = fwrite(entry, 12, 1, journal) == 1 && fwrite(bytes, size, 1, journal) == 1 && \
+            fwrite(check, 4, 1, journal) == 1;
+    }
+    ok = ok && fflush(journal) == 0 && fsync(fileno(journal)) == 0;
+    if (fclose(journal) != 0 || !ok || !replaySaveJournal(filename)) {
+        fprintf(stderr, "%s", translate("ERROR_WRITE_PUZZLES"));
+        exit(1);
+    }
+
+    for (int block = 0; block < blocks; ++block) {
+        if (dirty[block]) {
+            store.blockStates[block] = BLOCK_INTACT;
+        }
+    }
+    free(bytes);
+    free(dirty);
+}
+
+
+/// @brief Reads the next entry of a journal and checks it
+/// @param journal Journal positioned at an entry
+/// @param fileSize Size of the save the journal belongs to
+/// @param offset Receives the file offset of the entry
+/// @param bytes Receives the entry bytes, reallocated to fit
+/// @param size Receives the entry length
+/// @return 1: complete and intact; 0: otherwise
+static int readJournalEntry(FILE *journal, size_t fileSize, size_t *offset, unsigned char **bytes, size_t *size) {
+    unsigned char entry[12], check[4];
+    if (fread(entry, 12, 1, journal) != 1) {
+        return 0;
+    }
+    *offset = getLittleEndian(entry, 8);
+    *size = getLittleEndian(entry + 8, 4);
+    if (*size == 0 || *offset > fileSize || *size > fileSize - *offset) {
+        return 0;
+    }
+    unsigned char *buffer = realloc(*bytes, *size);
+    if (buffer == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    *bytes = buffer;
+    return fread(*bytes, *size, 1, journal) == 1 && fread(check, 4, 1, journal) == 1 && \
+        (saveChecksum(entry, 12) ^ saveChecksum(*bytes, *size)) == getLittleEndian(check, 4);
+}
+
+
+/// @brief Finishes a flush interrupted after its journal was complete, see flushInPlace()
+/// @param filename Save file
+/// @return 1: a complete journal was copied into the save; 0: there was none, or it was incomplete
+/// \ or not for this save and the save was left untouched
+/// @note The journal is removed either way. Exits if the save cannot be written.
+int replaySaveJournal(const char *filename) {
+    char journalName[BUFFER_SIZE];
+    snprintf(journalName, sizeof(journalName), "%s%s", filename, LAZY_JOURNAL_SUFFIX);
+    FILE *journal = fopen(journalName, "rb");
+    if (journal == NULL) {
+        return 0;
+    }
+
+    unsigned char header[LAZY_JOURNAL_HEADER_SIZE];
+    struct stat info;
+    int fd = open(filename, O_WRONLY);
+    int complete = fd >= 0 && fstat(fd, &info) == 0 && fread(header, sizeof(header), 1, journal) == 1 && \
+        memcmp(header, LAZY_JOURNAL_MAGIC, 4) == 0 && saveChecksum(header, 16) == getLittleEndian(header + 16, 4) && \
+        getLittleEndian(header + 8, 8) == (unsigned long long)info.st_size;
+    unsigned int entries = complete ? (unsigned int)getLittleEndian(header + 4, 4) : 0;
+
+    // check every entry before writing any, so a torn journal never reaches the save
+    unsigned char *bytes = NULL;
+    size_t offset, size;
+    for (unsigned int e = 0; e < entries && complete; ++e) {
+        complete = readJournalEntry(journal, info.st_size, &offset, &bytes, &size);
+    }
+    if (complete) {
+        fseek(journal, LAZY_JOURNAL_HEADER_SIZE, SEEK_SET);
+        for (unsigned int e = 0; e < entries; ++e) {
+            if (!readJournalEntry(journal, info.st_size, &offset, &bytes, &size) || \
+                pwrite(fd, bytes, size, offset) != (ssize_t)size) {
+                fprintf(stderr, "%s", translate("ERROR_WRITE_PUZZLES"));
+                exit(1);
+            }
+        }
+        if (fsync(fd) != 0) {
+            fprintf(stderr, "%s", translate("ERROR_WRITE_PUZZLES"));
+            exit(1);
+        }
+    }
+    else {
+        fprintf(stderr, "%s\n", translate("ERROR_SAVE_JOURNAL_DISCARDED"));
+    }
+
+    free(bytes);
+    fclose(journal);
+    if (fd >= 0) {
+        close(fd);
+    }
+    remove(journalName);
+    return complete;
+}
+
+
+/// @brief Rewrites the whole file after puzzles were added or deleted, then maps the new file
+/// @details writeSaveFile() renames a temporary file over the save, so a failed write leaves the old
+/// \ save intact. Materialised puzzles move to their new record numbers and stay valid.
+static void flushRewrite(const char *filename) {
+    writeSaveFile(filename, store.count, storeRecordSource, NULL);
+
+    LazySlot *slots = allocateSlots(store.slotCapacity);
+    int slotCount = 0;
+    for (int i = 0; i < store.count; ++i) {
+        LazySlot *slot = findSlot(store.slots, store.slotCapacity, physicalRecord(i));
+        if (slot->puzzle != NULL) {
+            LazySlot *moved = findSlot(slots, store.slotCapacity, i);
+            moved->record = i;
+            moved->puzzle = slot->puzzle;
+            slot->puzzle = NULL;
+            slotCount++;
+        }
+    }
+    for (int k = 0; k < store.slotCapacity; ++k) {
+        free(store.slots[k].puzzle);
+    }
+    free(store.slots);
+    store.slots = slots;
+    store.slotCount = slotCount;
+
+    if (!mapSaveFile(filename, SAVE_RECORD_SIZE, SAVE_BLOCK_RECORDS, store.count)) {
+        fprintf(stderr, "%s", translate("ERROR_OPEN_FILE"));
+        exit(1);
+    }
+    free(store.order);
+    store.order = NULL;
+    store.nextRecord = store.count;
+    memset(store.blockStates, BLOCK_INTACT, (store.count + SAVE_BLOCK_RECORDS - 1) / SAVE_BLOCK_RECORDS);
+}
+
+
+/// @brief Writes the changes made in lazy mode back to the save file
+/// @param filename Save file, the one the store was opened from
+/// @details Without added or deleted puzzles only the blocks holding changed records are rewritten,
+/// \ through a journal; otherwise the file is rewritten whole to a temporary file renamed over it.
+/// \ Either way a crash leaves the old or the new save. Materialised puzzles stay valid.
+void flushLazyStore(const char *filename) {
+    pthread_mutex_lock(&store.lock);
+    if (store.active) {
+        if (store.order == NULL && store.count == store.recordCount) {
+            flushInPlace(filename);
+        }
+        else {
+            flushRewrite(filename);
+        }
+    }
+    pthread_mutex_unlock(&store.lock);
+}
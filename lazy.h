@@ -0,0 +1,45 @@
+/**
+ * @file lazy.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for lazy.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef LAZY_H
+#define LAZY_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+
+
+/// @brief Appended to the save file name to name the journal written by flushLazyStore()
+#define LAZY_JOURNAL_SUFFIX ".journal"
+/// @brief First bytes of a journal
+#define LAZY_JOURNAL_MAGIC "SDKJ"
+/// @brief Size of the journal header: magic, block count, save file size, CRC-32
+#define LAZY_JOURNAL_HEADER_SIZE 20
+
+
+/// @brief Called by forEachLazyPuzzle() for every puzzle in order
+/// @details puzzle is only valid during the call unless it was already materialised
+typedef void (*LazyVisitor)(int index, Puzzle *puzzle, int materialised, void *context);
+
+
+int openLazyStore(const char *filename, const unsigned char *header);
+void closeLazyStore();
+int lazyStoreActive();
+int lazyPuzzleCount();
+Puzzle *lazyPuzzleAt(int n, int *created);
+int lazyPeekPuzzle(int n, Puzzle *copy);
+void lazyAppendPuzzle(const Puzzle *puzzle);
+void lazyDeletePuzzle(int n);
+void forEachLazyPuzzle(LazyVisitor visit, void *context);
+void flushLazyStore(const char *filename);
+int replaySaveJournal(const char *filename);
+
+
+#endif
@@ -12,14 +12,23 @@
 #include "./dependencies.h"
 #include "./puzzle.h"
 #include "./files.h"
+#include "./canon.h"
+#include "./lazy.h"
+#include "./cli.h"
 #include "./ui.h"
 
 
-int main() {
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        return runCommandLine(argc, argv);
+    }
+
     startTime = clock();
     logLaunch();
     atexit(logRuntime);
 
+    atexit(persistSolutionCache);
+
     srand(time(NULL)); // seed for random values
 
     int puzzleArrayCount = 0;
@@ -78,7 +87,8 @@ int main() {
     loadDataFromFile(&puzzleArray, &puzzleArrayCount);
     menuMain(&puzzleArray, &puzzleArrayCount, defaultPuzzles, defaultPuzzleCount);
 
-    free(puzzleArray);
+    freePuzzleArray(puzzleArray);
+    closeLazyStore();
 
     return 0;
 }
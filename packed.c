@@ -0,0 +1,114 @@
+/**
+ * @file packed.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Compact nibble-packed puzzle representation, solving and validating it in place
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./packed.h"
+
+
+/// @brief Converts a puzzle to packed form
+/// @param puzzle Puzzle to read
+/// @param packed Packed puzzle to write
+/// @note Values above 15 do not fit a nibble and are cut to their low four bits
+void packPuzzle(const Puzzle *puzzle, PackedPuzzle *packed) {
+    memset(packed, 0, sizeof(*packed));
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int i = cell / GRID_SIZE;
+        int j = cell % GRID_SIZE;
+        setPackedCell(packed->grid, cell, puzzle->grid[i][j]);
+        setPackedCell(packed->userGrid, cell, puzzle->userGrid[i][j]);
+        if (puzzle->map[i][j] == 1) {
+            packed->map[cell >> 3] |= 1u << (cell & 7);
+        }
+    }
+}
+
+
+/// @brief Converts a packed puzzle back to a puzzle
+/// @param packed Packed puzzle to read
+/// @param puzzle Puzzle to write, only grid, user grid and bitmap are set
+/// @note Rebuild derived fields (play tracker, grading, metadata) afterwards
+void unpackPuzzle(const PackedPuzzle *packed, Puzzle *puzzle) {
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int i = cell / GRID_SIZE;
+        int j = cell % GRID_SIZE;
+        puzzle->grid[i][j] = packedCell(packed->grid, cell);
+        puzzle->userGrid[i][j] = packedCell(packed->userGrid, cell);
+        puzzle->map[i][j] = packedGiven(packed, cell);
+    }
+}
+
+
+/// @brief Checks if the packed user grid is solved, without unpacking it
+/// @param packed Puzzle to check
+/// @return 1: every row, column and subgrid holds 1-9 exactly once; 0: otherwise
+int isPackedSolved(const PackedPuzzle *packed) {
+    unsigned int rowMask[GRID_SIZE] = {0}, colMask[GRID_SIZE] = {0}, boxMask[GRID_SIZE] = {0};
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int num = packedCell(packed->userGrid, cell);
+        if (num <= 0 || num > GRID_SIZE) {
+            return 0;
+        }
+        int row = cell / GRID_SIZE;
+        int col = cell % GRID_SIZE;
+        unsigned int bit = 1u << (num - 1);
+        rowMask[row] |= bit;
+        colMask[col] |= bit;
+        boxMask[boxOfSquare(row, col)] |= bit;
+    }
+
+    for (int k = 0; k < GRID_SIZE; ++k) {
+        if (rowMask[k] != ALL_DIGITS_MASK || colMask[k] != ALL_DIGITS_MASK || boxMask[k] != ALL_DIGITS_MASK) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Reads a square of a packed grid, see #CellReader
+static int readPackedCell(const void *grid, int cell) {
+    return packedCell(grid, cell);
+}
+
+
+/// @brief Solves the packed user grid with constraint propagation, without unpacking it
+/// @param packed Puzzle to solve
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @note User grid is left unchanged if no solution is found
+int solvePackedPuzzle(PackedPuzzle *packed) {
+    PropagationState state;
+    if (!loadPropagationCells(&state, readPackedCell, packed->userGrid) || !solvePropagationState(&state)) {
+        return 0;
+    }
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        setPackedCell(packed->userGrid, cell, state.cells[cell]);
+    }
+    return 1;
+}
+
+
+/// @brief Changes a packed user grid square if the bitmap allows
+/// @param packed Puzzle to modify
+/// @param row Square row
+/// @param col Square column
+/// @param value Value to write (0-9)
+/// @return -1: unchanged due to bitmap; 0: changed successfully
+int changePackedValue(PackedPuzzle *packed, int row, int col, int value) {
+    int cell = row * GRID_SIZE + col;
+    if (packedGiven(packed, cell)) {
+        return -1;
+    }
+    setPackedCell(packed->userGrid, cell, value);
+    return 0;
+}
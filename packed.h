@@ -0,0 +1,75 @@
+/**
+ * @file packed.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for packed.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PACKED_H
+#define PACKED_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+
+
+/// @brief Bytes of a grid stored as one nibble per square
+#define PACKED_GRID_BYTES ((GRID_SIZE * GRID_SIZE + 1) / 2)
+/// @brief Bytes of a bitmap stored as one bit per square
+#define PACKED_MAP_BYTES ((GRID_SIZE * GRID_SIZE + 7) / 8)
+
+
+/// @brief Compact form of the stored fields of a Puzzle, 93 bytes instead of 972
+/// @details Square k (row-major) is the low nibble of byte k / 2 if k is even, the high nibble
+/// \ otherwise; its bitmap bit is bit k % 8 of byte k / 8. Only bytes, so the layout is the
+/// \ same on every platform and records are written to files as they are.
+/// \ It is the puzzle part of save records (see encodeSaveRecord()); arrays in memory keep Puzzle.
+typedef struct PackedPuzzle {
+    /// @brief Grid values, see Puzzle
+    unsigned char grid[PACKED_GRID_BYTES];
+    /// @brief User grid values, see Puzzle
+    unsigned char userGrid[PACKED_GRID_BYTES];
+    /// @brief Bitmap of unmodifiable squares, see Puzzle
+    unsigned char map[PACKED_MAP_BYTES];
+} PackedPuzzle;
+
+
+/// @brief Reads a square of a nibble-packed grid
+/// @param cells Packed grid
+/// @param cell Row-major square index
+/// @return Square value
+static inline int packedCell(const unsigned char cells[PACKED_GRID_BYTES], int cell) {
+    return (cells[cell >> 1] >> ((cell & 1) << 2)) & 0xF;
+}
+
+
+/// @brief Writes a square of a nibble-packed grid
+/// @param cells Packed grid
+/// @param cell Row-major square index
+/// @param value Value to write (0-15)
+static inline void setPackedCell(unsigned char cells[PACKED_GRID_BYTES], int cell, int value) {
+    int shift = (cell & 1) << 2;
+    cells[cell >> 1] = (cells[cell >> 1] & ~(0xF << shift)) | ((value & 0xF) << shift);
+}
+
+
+/// @brief Reads a bitmap bit of a packed puzzle
+/// @param packed Puzzle to read
+/// @param cell Row-major square index
+/// @return 1: unmodifiable; 0: modifiable
+static inline int packedGiven(const PackedPuzzle *packed, int cell) {
+    return (packed->map[cell >> 3] >> (cell & 7)) & 1;
+}
+
+
+void packPuzzle(const Puzzle *puzzle, PackedPuzzle *packed);
+void unpackPuzzle(const PackedPuzzle *packed, Puzzle *puzzle);
+int isPackedSolved(const PackedPuzzle *packed);
+int solvePackedPuzzle(PackedPuzzle *packed);
+int changePackedValue(PackedPuzzle *packed, int row, int col, int value);
+
+
+#endif
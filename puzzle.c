@@ -9,11 +9,26 @@
  * 
  */
 
+#include <pthread.h>
+
 #include "./dependencies.h"
 #include "./puzzle.h"
+#include "./solver.h"
+#include "./dlx.h"
+#include "./bitboard.h"
+#include "./batch.h"
+#include "./grade.h"
+#include "./canon.h"
+#include "./lazy.h"
 #include "./ui.h"
 
 
+/// @brief Aggregates over the puzzle array, see PuzzleIndex
+PuzzleIndex puzzleIndex;
+/// @brief 1 while #puzzleIndex and the difficulty index are out of date, see ensurePuzzleIndexes()
+static int indexesPending = 0;
+
+
 /// @brief Generates bitmap in puzzle from its grid array values
 /// @param puzzle Puzzle for which to generate the bitmap
 void generateBitmap(Puzzle *puzzle) {
@@ -36,6 +51,234 @@ void generateUserGrid(Puzzle *puzzle) {
             puzzle->userGrid[i][j] = puzzle->grid[i][j];
         }
     }
+    rebuildPlayTracker(puzzle);
+    refreshPuzzleMeta(puzzle);
+}
+
+
+/// @brief Adds or removes one copy of a digit in the units of a square
+/// @param tracker Tracker to update
+/// @param row Square row
+/// @param col Square column
+/// @param num Digit (1-9)
+/// @param add 1: digit was written; 0: digit was erased
+static void trackDigit(PlayTracker *tracker, int row, int col, int num, int add) {
+    unsigned char *counts[3] = {
+        &tracker->rowCounts[row][num],
+        &tracker->colCounts[col][num],
+        &tracker->boxCounts[(row / SUBGRID_SIZE) * SUBGRID_SIZE + col / SUBGRID_SIZE][num]
+    };
+
+    for (int k = 0; k < 3; ++k) {
+        if (add) {
+            tracker->conflicts += (*counts[k] > 0);
+            (*counts[k])++;
+        }
+        else {
+            (*counts[k])--;
+            tracker->conflicts -= (*counts[k] > 0);
+        }
+    }
+    tracker->filled += add ? 1 : -1;
+}
+
+
+/// @brief Recounts the play tracker from the user grid
+/// @param puzzle Puzzle to recount
+/// @note Needed after anything but changeValue() writes to the user grid
+void rebuildPlayTracker(Puzzle *puzzle) {
+    memset(&puzzle->tracker, 0, sizeof(puzzle->tracker));
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            int num = puzzle->userGrid[i][j];
+            if (num > 0 && num <= GRID_SIZE) {
+                trackDigit(&puzzle->tracker, i, j, num, 1);
+            }
+        }
+    }
+}
+
+
+/// @brief Checks if user grid is solved using the play tracker, in O(1)
+/// @param puzzle Puzzle to check
+/// @return 1: solved; 0: unsolved
+/// @note Same result as isSudokuSolved() as long as the tracker is up to date
+int isPuzzleSolved(const Puzzle *puzzle) {
+    return puzzle->tracker.filled == GRID_SIZE * GRID_SIZE && puzzle->tracker.conflicts == 0;
+}
+
+
+/// @brief Checks if the digit in a user grid square also appears elsewhere in its row, column or subgrid
+/// @param puzzle Puzzle to check
+/// @param row Square row
+/// @param col Square column
+/// @return 1: conflicting; 0: empty or not conflicting
+int isSquareConflicting(const Puzzle *puzzle, int row, int col) {
+    int num = puzzle->userGrid[row][col];
+    if (num <= 0 || num > GRID_SIZE) {
+        return 0;
+    }
+    return puzzle->tracker.rowCounts[row][num] > 1 || puzzle->tracker.colCounts[col][num] > 1 || \
+        puzzle->tracker.boxCounts[(row / SUBGRID_SIZE) * SUBGRID_SIZE + col / SUBGRID_SIZE][num] > 1;
+}
+
+
+/// @brief Adds or removes the metadata of a puzzle from #puzzleIndex
+/// @param meta Metadata to add or remove
+/// @param sign 1: add; -1: remove
+static void indexPuzzleMeta(const PuzzleMeta *meta, int sign) {
+    puzzleIndex.puzzleCount += sign;
+    puzzleIndex.solvedCount += sign * meta->solved;
+    puzzleIndex.totalClues += sign * meta->clueCount;
+    puzzleIndex.clueCounts[meta->clueCount] += sign;
+    if (meta->solveTime > 0) {
+        puzzleIndex.totalSolveTime += sign * meta->solveTime;
+        puzzleIndex.timedCount += sign;
+    }
+}
+
+
+/// @brief Counts given squares of the grid
+/// @param puzzle Puzzle to count
+/// @return Number of non-empty grid squares
+static int countClues(const Puzzle *puzzle) {
+    int clueCount = 0;
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            clueCount += (puzzle->grid[i][j] > 0);
+        }
+    }
+    return clueCount;
+}
+
+
+/// @brief Updates the solved state of a puzzle from its play tracker, keeping #puzzleIndex in step
+/// @param puzzle Puzzle to update
+void refreshPuzzleMeta(Puzzle *puzzle) {
+    int solved = isPuzzleSolved(puzzle);
+    if (puzzle->meta.indexed) {
+        puzzleIndex.solvedCount += solved - puzzle->meta.solved;
+    }
+    puzzle->meta.solved = solved;
+}
+
+
+/// @brief Records a solver run in the metadata of a puzzle, keeping #puzzleIndex in step
+/// @param puzzle Solved puzzle
+/// @param seconds Wall-clock time the solve took
+/// @note Updates the shared #puzzleIndex, so call it from one thread at a time
+void recordSolveTime(Puzzle *puzzle, double seconds) {
+    if (puzzle->meta.indexed) {
+        indexPuzzleMeta(&puzzle->meta, -1);
+    }
+    puzzle->meta.solveTime = seconds;
+    puzzle->meta.lastModified = time(NULL);
+    puzzle->meta.solved = isPuzzleSolved(puzzle);
+    if (puzzle->meta.indexed) {
+        indexPuzzleMeta(&puzzle->meta, 1);
+    }
+}
+
+
+/// @brief Recomputes clue counts and solved states, then rebuilds #puzzleIndex from scratch
+/// @param puzzleArray Array to index, every puzzle is marked as indexed
+/// @param puzzleCount Array size
+/// @note Play trackers must be up to date
+void rebuildPuzzleIndex(PuzzleArray puzzleArray, int puzzleCount) {
+    memset(&puzzleIndex, 0, sizeof(puzzleIndex));
+    for (int i = 0; i < puzzleCount; ++i) {
+        PuzzleMeta *meta = &puzzleArray[i].meta;
+        meta->clueCount = countClues(&puzzleArray[i]);
+        meta->solved = isPuzzleSolved(&puzzleArray[i]);
+        meta->indexed = 1;
+        indexPuzzleMeta(meta, 1);
+    }
+}
+
+
+/// @brief Marks #puzzleIndex and the difficulty index as out of date until ensurePuzzleIndexes()
+/// @details Used in lazy mode, where building them needs a pass over every record of the save
+void invalidatePuzzleIndexes() {
+    memset(&puzzleIndex, 0, sizeof(puzzleIndex));
+    rebuildDifficultyIndex(NULL, 0);
+    indexesPending = 1;
+}
+
+
+/// @brief Adds a puzzle to both indexes while ensurePuzzleIndexes() scans the lazy store
+static void indexLazyPuzzle(int index, Puzzle *puzzle, int materialised, void *context) {
+    puzzle->meta.clueCount = countClues(puzzle);
+    puzzle->meta.solved = isPuzzleSolved(puzzle);
+    puzzle->meta.indexed = 1;
+    indexPuzzleMeta(&puzzle->meta, 1);
+    addToDifficultyIndex(index, puzzle->difficulty);
+}
+
+
+/// @brief Grades the nth puzzle if it is ungraded, moving it to its bucket of the difficulty index
+/// @param puzzleArray Loaded puzzle array, NULL in lazy mode
+/// @param n Position in the collection
+/// @return Puzzle, see puzzleAt()
+Puzzle *gradedPuzzleAt(PuzzleArray puzzleArray, int n) {
+    Puzzle *puzzle = puzzleAt(puzzleArray, n);
+    if (puzzle->difficulty == DIFFICULTY_UNGRADED) {
+        gradePuzzle(puzzle);
+        if (!indexesPending) {
+            removeFromDifficultyIndex(n, DIFFICULTY_UNGRADED);
+            addToDifficultyIndex(n, puzzle->difficulty);
+        }
+    }
+    return puzzle;
+}
+
+
+/// @brief Builds #puzzleIndex and the difficulty index if they are out of date, then grades ungraded puzzles
+/// @param puzzleArray Loaded puzzle array
+/// @param puzzleCount Array size
+/// @details Both are kept up to date for arrays loaded whole, so the rebuild only happens in lazy
+/// \ mode after loading. Records are decoded one at a time without materialising them.
+/// \ Added puzzles wait in the ungraded bucket, see appendPuzzles(), and are graded here.
+void ensurePuzzleIndexes(PuzzleArray puzzleArray, int puzzleCount) {
+    if (indexesPending) {
+        if (puzzleArray == NULL && lazyStoreActive()) {
+            memset(&puzzleIndex, 0, sizeof(puzzleIndex));
+            rebuildDifficultyIndex(NULL, 0);
+            forEachLazyPuzzle(indexLazyPuzzle, NULL);
+        }
+        else {
+            rebuildDifficultyIndex(puzzleArray, puzzleCount);
+            rebuildPuzzleIndex(puzzleArray, puzzleCount);
+        }
+        indexesPending = 0;
+    }
+
+    while (difficultyIndex.counts[DIFFICULTY_UNGRADED] > 0) {
+        int n = difficultyIndex.buckets[DIFFICULTY_UNGRADED][difficultyIndex.counts[DIFFICULTY_UNGRADED] - 1];
+        if (gradedPuzzleAt(puzzleArray, n)->difficulty == DIFFICULTY_UNGRADED) {
+            break;
+        }
+    }
+}
+
+
+/// @brief Finds the nth puzzle of the loaded collection, whether it is loaded whole or in lazy mode
+/// @param puzzleArray Loaded puzzle array, NULL in lazy mode
+/// @param n Position in the collection
+/// @return Puzzle to read or modify in place
+/// @note Thread safe; in lazy mode the puzzle is decoded from the save on first access
+Puzzle *puzzleAt(PuzzleArray puzzleArray, int n) {
+    if (puzzleArray != NULL || !lazyStoreActive()) {
+        return &puzzleArray[n];
+    }
+
+    int created;
+    Puzzle *puzzle = lazyPuzzleAt(n, &created);
+    if (created) {
+        puzzle->meta.clueCount = countClues(puzzle);
+        puzzle->meta.solved = isPuzzleSolved(puzzle);
+        puzzle->meta.indexed = !indexesPending;
+    }
+    return puzzle;
 }
 
 
@@ -45,29 +288,231 @@ void generateUserGrid(Puzzle *puzzle) {
 /// @param y Cartesian y coordinate of square
 /// @param value Value to write
 /// @return -1: unchanged due to bitmap; 0: changed successfully
+/// @note Updates the play tracker and puzzle metadata
 int changeValue(Puzzle *puzzle, int x, int y, int value) {
-    if (puzzle->map[GRID_SIZE-y][x-1] == 0) {
-        puzzle->userGrid[GRID_SIZE-y][x-1] = value;
+    int row = GRID_SIZE - y;
+    int col = x - 1;
+    if (puzzle->map[row][col] == 0) {
+        int old = puzzle->userGrid[row][col];
+        if (old > 0 && old <= GRID_SIZE) {
+            trackDigit(&puzzle->tracker, row, col, old, 0);
+        }
+        puzzle->userGrid[row][col] = value;
+        if (value > 0 && value <= GRID_SIZE) {
+            trackDigit(&puzzle->tracker, row, col, value, 1);
+        }
+        puzzle->meta.lastModified = time(NULL);
+        refreshPuzzleMeta(puzzle);
         return 0;
     }
     return -1; 
 }
 
 
-/// @brief Dynamically appends puzzle to array and handles memory allocation
-/// @param puzzle Puzzle to append
-/// @param puzzleArray Array to append to
-/// @param puzzleCount Array size, increments +1 after automatically
-void addPuzzle(Puzzle puzzle, PuzzleArray *puzzleArray, int *puzzleCount) {
-    *puzzleArray = realloc(*puzzleArray, (*puzzleCount + 1) * sizeof(Puzzle));
+/// @brief Finds the bookkeeping in front of a puzzle array
+/// @param puzzleArray Array made by allocatePuzzleArray(), not NULL
+/// @return Its header
+static PuzzleArrayHeader *arrayHeader(PuzzleArray puzzleArray) {
+    return (PuzzleArrayHeader*)((char*)puzzleArray - PUZZLE_ARRAY_HEADER_SIZE);
+}
+
+
+/// @brief Allocates an empty puzzle array
+/// @param capacity Puzzles it can hold before growing
+/// @return Array to index like a plain Puzzle*, free with freePuzzleArray()
+/// @details Its capacity and handle table are kept in a header in front of the first puzzle,
+/// \ so arrays keep the PuzzleArray type and an array size is still passed alongside.
+PuzzleArray allocatePuzzleArray(int capacity) {
+    if (capacity < PUZZLE_ARRAY_MIN_CAPACITY) {
+        capacity = PUZZLE_ARRAY_MIN_CAPACITY;
+    }
+    char *block = malloc(PUZZLE_ARRAY_HEADER_SIZE + (size_t)capacity * sizeof(Puzzle));
+    if (block == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    PuzzleArrayHeader *header = (PuzzleArrayHeader*)block;
+    memset(header, 0, sizeof(*header));
+    header->capacity = capacity;
+    return (PuzzleArray)(block + PUZZLE_ARRAY_HEADER_SIZE);
+}
+
+
+/// @brief Frees a puzzle array and its handle table
+/// @param puzzleArray Array made by allocatePuzzleArray(), or NULL
+void freePuzzleArray(PuzzleArray puzzleArray) {
+    if (puzzleArray == NULL) {
+        return;
+    }
+    PuzzleArrayHeader *header = arrayHeader(puzzleArray);
+    free(header->positions);
+    free(header);
+}
+
+
+/// @brief Finds how many puzzles an array can hold before growing
+/// @param puzzleArray Array made by allocatePuzzleArray(), or NULL
+/// @return Capacity in puzzles, 0 for NULL
+int puzzleArrayCapacity(PuzzleArray puzzleArray) {
+    return puzzleArray == NULL ? 0 : arrayHeader(puzzleArray)->capacity;
+}
+
+
+/// @brief Makes room for more puzzles, so appending them does not reallocate
+/// @param puzzleArray Array to grow, NULL allocates one
+/// @param puzzleCount Array size
+/// @param n Puzzles about to be appended
+/// @details Capacity at least doubles when it grows, so n appends of one puzzle copy the array
+/// \ O(log n) times instead of n times. Puzzles may move; handles stay valid.
+void reservePuzzles(PuzzleArray *puzzleArray, int puzzleCount, int n) {
+    int capacity = puzzleArrayCapacity(*puzzleArray);
+    if (puzzleCount + n <= capacity && *puzzleArray != NULL) {
+        return;
+    }
     if (*puzzleArray == NULL) {
+        *puzzleArray = allocatePuzzleArray(puzzleCount + n);
+        return;
+    }
+
+    capacity = (2 * capacity > puzzleCount + n) ? 2 * capacity : puzzleCount + n;
+    PuzzleArrayHeader *header = realloc(arrayHeader(*puzzleArray), \
+        PUZZLE_ARRAY_HEADER_SIZE + (size_t)capacity * sizeof(Puzzle));
+    if (header == NULL) {
         fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
         exit(1);
     }
-    generateBitmap(&puzzle);
-    generateUserGrid(&puzzle);
-    (*puzzleArray)[*puzzleCount] = puzzle;
-    *puzzleCount = *puzzleCount + 1;
+    header->capacity = capacity;
+    *puzzleArray = (PuzzleArray)((char*)header + PUZZLE_ARRAY_HEADER_SIZE);
+}
+
+
+/// @brief Gives a puzzle of an array a new handle
+/// @param puzzleArray Array holding the puzzle
+/// @param position Position of the puzzle in the array
+static void givePuzzleHandle(PuzzleArray puzzleArray, int position) {
+    PuzzleArrayHeader *header = arrayHeader(puzzleArray);
+    if (header->handleCount == header->handleCapacity) {
+        int capacity = header->handleCapacity ? 2 * header->handleCapacity : header->capacity;
+        int *positions = realloc(header->positions, capacity * sizeof(int));
+        if (positions == NULL) {
+            fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+            exit(1);
+        }
+        header->positions = positions;
+        header->handleCapacity = capacity;
+    }
+    puzzleArray[position].meta.handle = header->handleCount;
+    header->positions[header->handleCount++] = position;
+}
+
+
+/// @brief Gives every puzzle of a freshly loaded array a handle, in array order
+/// @param puzzleArray Array made by allocatePuzzleArray(), or NULL
+/// @param puzzleCount Array size
+/// @note Handles given out before are no longer valid
+void resetPuzzleHandles(PuzzleArray puzzleArray, int puzzleCount) {
+    if (puzzleArray == NULL) {
+        return;
+    }
+    arrayHeader(puzzleArray)->handleCount = 0;
+    for (int i = 0; i < puzzleCount; ++i) {
+        givePuzzleHandle(puzzleArray, i);
+    }
+}
+
+
+/// @brief Finds a puzzle by the handle it was given when added or loaded
+/// @param puzzleArray Array holding the puzzle, not lazy mode
+/// @param handle Handle of the puzzle, see PuzzleMeta
+/// @return Position of the puzzle in the array; -1 if it was deleted or the handle is unknown
+/// @details Positions change when puzzles are deleted, see deleteNthPuzzle(), handles do not
+int findPuzzleHandle(PuzzleArray puzzleArray, int handle) {
+    if (puzzleArray == NULL || handle < 0 || handle >= arrayHeader(puzzleArray)->handleCount) {
+        return -1;
+    }
+    return arrayHeader(puzzleArray)->positions[handle];
+}
+
+
+/// @brief Fills every field of a puzzle about to be appended from its grid
+/// @param puzzle Puzzle to fill
+/// @param grid Grid of the puzzle
+/// @note Same result as generateBitmap(), generateUserGrid() and countClues() on a cleared puzzle, but
+/// \ about twice as fast, which matters for bulk imports; the puzzle is left ungraded
+static void loadAppendedPuzzle(Puzzle *puzzle, const int grid[GRID_SIZE][GRID_SIZE]) {
+    memcpy(puzzle->grid, grid, sizeof(puzzle->grid));
+    memcpy(puzzle->userGrid, grid, sizeof(puzzle->userGrid));
+    const int *cells = &puzzle->grid[0][0];
+    unsigned char *map = &puzzle->map[0][0];
+    int clueCount = 0;
+    for (int k = 0; k < CELL_COUNT; ++k) {
+        map[k] = (cells[k] > 0);
+        clueCount += map[k];
+    }
+
+    // same counts as trackDigit() on every digit, without its per-square branches on add
+    PlayTracker *tracker = &puzzle->tracker;
+    memset(tracker, 0, sizeof(*tracker));
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            int num = grid[row][col];
+            if (num > 0 && num <= GRID_SIZE) {
+                unsigned char *box = tracker->boxCounts[(row / SUBGRID_SIZE) * SUBGRID_SIZE + col / SUBGRID_SIZE];
+                tracker->conflicts += (tracker->rowCounts[row][num]++ > 0) + (tracker->colCounts[col][num]++ > 0) + \
+                    (box[num]++ > 0);
+                tracker->filled++;
+            }
+        }
+    }
+
+    puzzle->difficulty = DIFFICULTY_UNGRADED;
+    puzzle->rating = 0;
+    memset(&puzzle->meta, 0, sizeof(puzzle->meta));
+    puzzle->meta.clueCount = clueCount;
+    puzzle->meta.solved = isPuzzleSolved(puzzle);
+}
+
+
+/// @brief Appends puzzle to array, growing it geometrically
+/// @param puzzle Puzzle to append, only its grid is read
+/// @param puzzleArray Array to append to
+/// @param puzzleCount Array size, increments +1 after automatically
+/// @note Gives the puzzle a handle and adds it to #puzzleIndex and, ungraded, to the difficulty index
+void addPuzzle(const Puzzle *puzzle, PuzzleArray *puzzleArray, int *puzzleCount) {
+    appendPuzzles(puzzle, 1, puzzleArray, puzzleCount);
+}
+
+
+/// @brief Appends several puzzles to array, reserving room for all of them first
+/// @param puzzles Puzzles to append, only their grids are read
+/// @param n Number of puzzles
+/// @param puzzleArray Array to append to
+/// @param puzzleCount Array size, increments +n after automatically
+/// @details Same as calling addPuzzle() for each. Every other field is rebuilt from the grid, except
+/// \ the difficulty: grading costs more than the rest of an append, so puzzles are left ungraded
+/// \ until the difficulty index is used, see ensurePuzzleIndexes() and gradedPuzzleAt().
+void appendPuzzles(const Puzzle *puzzles, int n, PuzzleArray *puzzleArray, int *puzzleCount) {
+    int lazy = (*puzzleArray == NULL && lazyStoreActive());
+    Puzzle scratch;
+    if (!lazy && n > 0) {
+        reservePuzzles(puzzleArray, *puzzleCount, n);
+    }
+    for (int k = 0; k < n; ++k) {
+        Puzzle *puzzle = lazy ? &scratch : &(*puzzleArray)[*puzzleCount];
+        loadAppendedPuzzle(puzzle, puzzles[k].grid);
+        puzzle->meta.indexed = !indexesPending;
+        if (puzzle->meta.indexed) {
+            indexPuzzleMeta(&puzzle->meta, 1);
+            addToDifficultyIndex(*puzzleCount, puzzle->difficulty);
+        }
+        if (lazy) {
+            lazyAppendPuzzle(puzzle);
+        }
+        else {
+            givePuzzleHandle(*puzzleArray, *puzzleCount);
+        }
+        *puzzleCount = *puzzleCount + 1;
+    }
 }
 
 
@@ -111,7 +556,7 @@ int checkColumn(Puzzle puzzle, int col) {
 }
 
 
-/// @brief Checks if puzzle puzzle 3x3 subgrid includes 1-9 exactly once
+/// @brief Checks if puzzle subgrid includes 1-9 exactly once
 /// @param puzzle Puzzle to check
 /// @param startRow Subgrid start row
 /// @param startCol Subgrid start column
@@ -119,8 +564,8 @@ int checkColumn(Puzzle puzzle, int col) {
 int checkBox(Puzzle puzzle, int startRow, int startCol) {
     for (int num = 1; num <= GRID_SIZE; ++num) {
         int count = 0;
-        for (int i = startRow; i < startRow + 3; ++i) {
-            for (int j = startCol; j < startCol + 3; ++j) {
+        for (int i = startRow; i < startRow + SUBGRID_SIZE; ++i) {
+            for (int j = startCol; j < startCol + SUBGRID_SIZE; ++j) {
                 if (puzzle.userGrid[i][j] == num) {
                     ++count;
                 }
@@ -143,8 +588,8 @@ int isSudokuSolved(Puzzle puzzle) {
             return 0;
         }
     }
-    for (int i = 0; i < GRID_SIZE; i += 3) {
-        for (int j = 0; j < GRID_SIZE; j += 3) {
+    for (int i = 0; i < GRID_SIZE; i += SUBGRID_SIZE) {
+        for (int j = 0; j < GRID_SIZE; j += SUBGRID_SIZE) {
             if (!checkBox(puzzle, i, j)) {
                 return 0;
             }
@@ -170,10 +615,10 @@ int isSquareSafe(Puzzle *puzzle, int row, int col, int num) {
         if (puzzle->userGrid[x][col] == num)
             return 0;
 
-    int startRow = row - row % 3;
-    int startCol = col - col % 3;
-    for (int i = 0; i < 3; i++)
-        for (int j = 0; j < 3; j++)
+    int startRow = row - row % SUBGRID_SIZE;
+    int startCol = col - col % SUBGRID_SIZE;
+    for (int i = 0; i < SUBGRID_SIZE; i++)
+        for (int j = 0; j < SUBGRID_SIZE; j++)
             if (puzzle->userGrid[i + startRow][j + startCol] == num)
                 return 0;
 
@@ -181,36 +626,80 @@ int isSquareSafe(Puzzle *puzzle, int row, int col, int num) {
 }
 
 
-/// @brief Solves user grid of puzzle
-/// @param puzzle Puzzle to solve
-/// @param row Call with 0, used by recursive calls
-/// @param col Call with 0, used by recursive calls
-/// @return 0: unsolvable if returned by initial call; used to trigger backtrack in recursion
-/// @details Uses a backtracking (brute-force) algorithm. More optimized algorithms (e.g. stochastic search) are outside the scope of this project.
-int solveSudokuUserGrid(Puzzle *puzzle, int row, int col) {
-    if (row == GRID_SIZE - 1 && col == GRID_SIZE)
-        return 1;
+/// @brief Finds elapsed wall-clock time, the parallel engine runs on several cores so CPU time would overstate it
+/// @return Seconds since an arbitrary point
+static double wallTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
 
-    if (col == GRID_SIZE) {
-        row++;
-        col = 0;
+
+/// @brief Solves user grid of puzzle using the engine selected in #solverEngine, without the cache
+/// @param puzzle Puzzle to solve
+/// @param row Row to start searching from (backtracking engines only)
+/// @param col Column to start searching from (backtracking engines only)
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @note Safe to call from several threads at once
+/// @note In instrumented builds solverStats holds the work of the call afterwards
+int solveSudokuUncached(Puzzle *puzzle, int row, int col) {
+    int solved;
+    STAT_BEGIN();
+    switch (solverEngine) {
+        case SOLVER_ENGINE_PROPAGATE:
+            solved = solveSudokuPropagation(puzzle);
+            break;
+        case SOLVER_ENGINE_DLX:
+            solved = solveSudokuDlx(puzzle);
+            break;
+        case SOLVER_ENGINE_BITBOARD:
+            solved = solveSudokuBitboard(puzzle);
+            break;
+        case SOLVER_ENGINE_PARALLEL:
+            solved = solveSudokuParallel(puzzle, 0);
+            break;
+        default: {
+            SolverState state;
+            loadSolverState(&state, puzzle->userGrid);
+            STAT_PHASE(SOLVER_PHASE_SEARCH);
+            solved = (solverEngine == SOLVER_ENGINE_ITERATIVE) ? \
+                solveSolverStateIterative(&state, row * GRID_SIZE + col) : solveSolverState(&state, row * GRID_SIZE + col);
+            STAT_PHASE(SOLVER_PHASE_STORE);
+            if (solved) {
+                storeSolverState(&state, puzzle->userGrid);
+            }
+        }
     }
+    STAT_END();
+    return solved;
+}
 
-    if (puzzle->userGrid[row][col] > 0)        
-        return solveSudokuUserGrid(puzzle, row, col + 1);
 
-    for (int num = 1; num <= GRID_SIZE; num++) {
-        if (isSquareSafe(puzzle, row, col, num)) {
-            puzzle->userGrid[row][col] = num;
+/// @brief Solves the whole user grid with the selected engine, called on solution cache misses
+static int solveFromFirstSquare(Puzzle *puzzle) {
+    return solveSudokuUncached(puzzle, 0, 0);
+}
 
-            if (solveSudokuUserGrid(puzzle, row, col + 1))
-                return 1;
-        }
 
-        puzzle->userGrid[row][col] = 0;  // undo the current square for backtracking
+/// @brief Solves user grid of puzzle using the engine selected in #solverEngine
+/// @param puzzle Puzzle to solve
+/// @param row Call with 0, row to start searching from (backtracking engines only)
+/// @param col Call with 0, column to start searching from (backtracking engines only)
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @details The backtracking engines work on a SolverState, which tracks used digits as row,
+/// \ column and subgrid bitmasks. Other engines always search the whole grid.
+/// \ If #solutionCacheEnabled is set, puzzles equal or symmetric to one solved before are answered
+/// \ from the cache. User grid is left unchanged if no solution is found, the play tracker
+/// \ and metadata are updated if one is.
+int solveSudokuUserGrid(Puzzle *puzzle, int row, int col) {
+    double start = wallTime();
+    int solved = (solutionCacheEnabled && row == 0 && col == 0) ? \
+        solveSudokuCached(puzzle, solveFromFirstSquare) : solveSudokuUncached(puzzle, row, col);
+    if (solved) {
+        rebuildPlayTracker(puzzle);
+        recordSolveTime(puzzle, wallTime() - start);
     }
-
-    return 0;
+    return solved;
 }
 
 
@@ -218,11 +707,11 @@ int solveSudokuUserGrid(Puzzle *puzzle, int row, int col) {
 /// @param puzzleArrayCount  Array size
 /// @param puzzleArray Array to check
 /// @return Number of solved puzzles in array
-/// @note Can be optimized in the future by storing .solved value in Puzzle structure
+/// @note Uses the play trackers; for the loaded puzzle array #puzzleIndex already holds the count
 int countSolvedSudokus(int puzzleArrayCount, PuzzleArray puzzleArray) {
     int solvedCount = 0;
     for (int i = 0; i < puzzleArrayCount; ++i) {
-        if (isSudokuSolved(puzzleArray[i]) == 1) {
+        if (isPuzzleSolved(puzzleAt(puzzleArray, i)) == 1) {
             ++solvedCount;
         }
     }
@@ -232,8 +721,9 @@ int countSolvedSudokus(int puzzleArrayCount, PuzzleArray puzzleArray) {
 
 /// @brief Generates valid random values for subgrids across the primary diagonal
 /// @param puzzle Puzzle to fill
-/// @details Shuffled using Fisher-Yates algorithm, relies on <time.h> to seed on launch
-void fillUserGridDiagonal(Puzzle* puzzle) {
+/// @param random Stream to shuffle with; NULL uses rand(), seeded on launch
+/// @details Shuffled using Fisher-Yates algorithm
+void fillUserGridDiagonal(Puzzle* puzzle, RandomStream *random) {
     for (int i = 0; i < GRID_SIZE; i += SUBGRID_SIZE) {
         int numbers[GRID_SIZE];
         for (int j = 0; j < GRID_SIZE; ++j) {
@@ -242,7 +732,7 @@ void fillUserGridDiagonal(Puzzle* puzzle) {
 
         // Shuffle
         for (int j = GRID_SIZE - 1; j > 0; --j) {
-            int r = rand() % (j + 1);
+            int r = randomBelow(random, j + 1);
             int temp = numbers[j];
             numbers[j] = numbers[r];
             numbers[r] = temp;
@@ -257,33 +747,42 @@ void fillUserGridDiagonal(Puzzle* puzzle) {
 }
 
 
-/// @brief Clears user grid squares until n clues remain
-/// @param puzzle Puzzle to modify
-/// @param n How many clues (non-empty squares) should remain 
-void setNCluesInUserGrid(Puzzle* puzzle, int n) {
-    srand(time(NULL));
+/// @brief Solution grids drawSolutionGrid() transforms, built on first use
+static int seedGrids[GENERATOR_SEED_GRIDS][GRID_SIZE][GRID_SIZE];
+/// @brief Builds seedGrids once, whichever generator thread gets there first
+static pthread_once_t seedGridsOnce = PTHREAD_ONCE_INIT;
 
-    int clues = 0;
-    for (int i = 0; i < GRID_SIZE; ++i) {
-        for (int j = 0; j < GRID_SIZE; ++j) {
-            if (puzzle->userGrid[i][j] != 0) {
-                clues++;
-            }
-        }
-    }
 
-    // Clear squares
-    while (clues > n) {
-        int i = rand() % GRID_SIZE;
-        int j = rand() % GRID_SIZE;
-        if (puzzle->userGrid[i][j] != 0) {
-            puzzle->userGrid[i][j] = 0;
-            clues--;
-        }
+/// @brief Searches the seed grids: shuffled diagonal subgrids completed by the solver
+/// @details Drawn from a fixed stream, so every run transforms the same seed grids
+static void buildSeedGrids() {
+    Puzzle puzzle;
+    RandomStream random;
+    for (int k = 0; k < GENERATOR_SEED_GRIDS; ++k) {
+        memset(&puzzle, 0, sizeof(puzzle));
+        seedRandomStream(&random, GENERATOR_SEED_GRID_SEED, k);
+        fillUserGridDiagonal(&puzzle, &random);
+        solveSudokuPropagation(&puzzle);
+        memcpy(seedGrids[k], puzzle.userGrid, sizeof(seedGrids[k]));
     }
 }
 
 
+/// @brief Makes a random solution grid without searching
+/// @param grid Grid to fill
+/// @param random Stream to draw from; NULL uses rand(), which is not thread-safe
+/// @details Applies a random symmetry transform to one of #GENERATOR_SEED_GRIDS seed grids.
+/// \ Each seed grid has about 1.2 * 10^12 transforms, so grids rarely repeat, at the cost of
+/// \ one permutation per grid instead of a search.
+void drawSolutionGrid(int grid[GRID_SIZE][GRID_SIZE], RandomStream *random) {
+    GridTransform transform;
+    pthread_once(&seedGridsOnce, buildSeedGrids);
+    int seed = randomBelow(random, GENERATOR_SEED_GRIDS);
+    randomGridTransform(&transform, random);
+    applyTransform(&transform, seedGrids[seed], grid);
+}
+
+
 /// @brief Copies values from user grid to grid in puzzle
 /// @param puzzle Puzzle to modify
 void copyUserGridtoGrid(Puzzle *puzzle) {
@@ -295,51 +794,149 @@ void copyUserGridtoGrid(Puzzle *puzzle) {
 }
 
 
+/// @brief Clears user grid squares one at a time, keeping only removals that leave a unique solution
+/// @param puzzle Puzzle whose user grid holds a full solution, receives the clues left
+/// @param clues Stop once this many clues remain
+/// @param minimal 1: ignore clues and try every square, so no clue left can be removed
+/// @param random Stream to pick the order with; NULL uses rand()
+/// @return Number of clues left
+/// @details Squares are tried once each in random order. A removal is kept only if no solution
+/// \ puts another digit in that square, which, with the solution known, means the puzzle still has
+/// \ exactly one; hasSolutionAvoiding() looks for a single solution instead of counting to two.
+/// \ Removing clues never takes solutions away, so a square that had to stay is needed for the
+/// \ rest of the pass too and one pass is enough for a minimal puzzle. The grid is loaded into
+/// \ solver state once; each try copies it and clears one square with clearDigit() instead of
+/// \ loading the grid again.
+int removeCluesUniquely(Puzzle *puzzle, int clues, int minimal, RandomStream *random) {
+    int order[GRID_SIZE * GRID_SIZE];
+    int left = GRID_SIZE * GRID_SIZE;
+
+    for (int cell = 0; cell < left; ++cell) {
+        order[cell] = cell;
+    }
+    for (int k = left - 1; k > 0; --k) {
+        int r = randomBelow(random, k + 1);
+        int temp = order[k];
+        order[k] = order[r];
+        order[r] = temp;
+    }
+
+    PropagationState current, trial;
+    loadPropagationState(&current, puzzle->userGrid);
+
+    for (int k = 0; k < GRID_SIZE * GRID_SIZE && (minimal || left > clues); ++k) {
+        int *square = &puzzle->userGrid[order[k] / GRID_SIZE][order[k] % GRID_SIZE];
+        int value = *square;
+        trial = current;
+        clearDigit(&trial, order[k]);
+        if (!hasSolutionAvoiding(&trial, order[k], value)) {
+            *square = 0;
+            clearDigit(&current, order[k]);
+            left--;
+        }
+    }
+    return left;
+}
+
+
+/// @brief Generates a puzzle with a unique solution
+/// @param puzzle Puzzle to fill: grid, user grid (a copy of the grid) and bitmap
+/// @param clues Clues wanted; with minimal, the most clues allowed
+/// @param minimal 1: every clue is needed, removing any would allow a second solution
+/// @param random Stream to draw from; NULL uses rand(), which is not thread-safe
+/// @return Clues of the puzzle, more than asked for if no solution grid allowed fewer
+/// \ within #GENERATOR_MAX_ATTEMPTS tries
+/// @details Each try starts from a new solution grid, see drawSolutionGrid(). Most tries reach
+/// \ 24 or more clues before every square is needed, lower counts take several tries.
+int generateUniquePuzzle(Puzzle *puzzle, int clues, int minimal, RandomStream *random) {
+    int best[GRID_SIZE][GRID_SIZE];
+    int bestClues = GRID_SIZE * GRID_SIZE + 1;
+
+    for (int attempt = 0; attempt < GENERATOR_MAX_ATTEMPTS && bestClues > clues; ++attempt) {
+        drawSolutionGrid(puzzle->userGrid, random);
+        int left = removeCluesUniquely(puzzle, clues, minimal, random);
+        if (left < bestClues) {
+            bestClues = left;
+            memcpy(best, puzzle->userGrid, sizeof(best));
+        }
+    }
+
+    memcpy(puzzle->userGrid, best, sizeof(best));
+    copyUserGridtoGrid(puzzle);
+    memset(puzzle->map, 0, sizeof(puzzle->map));
+    generateBitmap(puzzle);
+    rebuildPlayTracker(puzzle);
+    return bestClues;
+}
+
+
 /// @brief Generates and appends a valid puzzle with specified number of clues to array
 /// @param puzzleArrayPtr Array to append to
 /// @param puzzleCountPtr Array size
 /// @param clues Number of clues puzzle will have (n>=17)
-/// @note Make sure new puzzle is properly allocated in stack - current method works based on testing
-/// @details Dependant on helper functions: 
-/// \ generateUserGrid(), fillUserGridDiagonal(), solveSudokuUserGrid(), setNCluesInUserGrid(),
-/// \ copyUserGridtoGrid(), generateBitmap(), addPuzzle()
+/// @details The puzzle always has a unique solution, see generateUniquePuzzle(); it may have
+/// \ more clues than asked for if that many cannot be removed. Draws from a stream seeded with
+/// \ the current time, like generatePuzzleBatch() draws from its seeded streams; each call takes
+/// \ the next stream so puzzles generated within one second still differ.
 void generatePuzzle(PuzzleArray *puzzleArrayPtr, int *puzzleCountPtr, int clues) {
-    // needed; otherwise puzzle not properly initalized
-    // alternative is to pass empty puzzle from main --> more memory used in call stack
-    Puzzle newPuzzle = {{
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0}, 
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0}
-        }};
-
-    generateUserGrid(&newPuzzle);
-    fillUserGridDiagonal(&newPuzzle);
-    solveSudokuUserGrid(&newPuzzle, 0, 0);
-    setNCluesInUserGrid(&newPuzzle, clues);
-    copyUserGridtoGrid(&newPuzzle);
-    generateBitmap(&newPuzzle);
-    addPuzzle(newPuzzle, puzzleArrayPtr, puzzleCountPtr);
-}
-
-
-/// @brief Deletes nth puzzle from array and reallocates memory
+    static unsigned long long generated = 0;
+    Puzzle newPuzzle = {0};
+    RandomStream random;
+    seedRandomStream(&random, (unsigned long long)time(NULL), generated++);
+
+    generateUniquePuzzle(&newPuzzle, clues, 0, &random);
+    addPuzzle(&newPuzzle, puzzleArrayPtr, puzzleCountPtr);
+}
+
+
+/// @brief Deletes nth puzzle from array by moving the last puzzle into its place
 /// @param puzzleArrayPtr Array to delete from
 /// @param puzzleCountPtr Array size, increments -1 after automatically
 /// @param n nth puzzle to delete, 
+/// @details Copies at most one puzzle and never reallocates; the array keeps its capacity.
+/// \ The last puzzle takes position n, its handle still finds it, see findPuzzleHandle().
+/// @note In lazy mode the two puzzles involved are decoded into copies to update the indexes,
+/// \ neither is materialised
 void deleteNthPuzzle(PuzzleArray *puzzleArrayPtr, int *puzzleCountPtr, int n) {
-    for (int i = n; i < *puzzleCountPtr - 1; ++i) {
-        (*puzzleArrayPtr)[i] = (*puzzleArrayPtr)[i + 1];
+    if (*puzzleArrayPtr == NULL && lazyStoreActive()) {
+        int last = *puzzleCountPtr - 1;
+        if (!indexesPending) {
+            Puzzle copy;
+            if (!lazyPeekPuzzle(n, &copy)) {
+                copy.meta.clueCount = countClues(&copy);
+                copy.meta.solved = isPuzzleSolved(&copy);
+                copy.meta.indexed = 1;
+            }
+            if (copy.meta.indexed) {
+                indexPuzzleMeta(&copy.meta, -1);
+            }
+            removeFromDifficultyIndex(n, copy.difficulty);
+            if (n != last) {
+                lazyPeekPuzzle(last, &copy);
+                renumberInDifficultyIndex(last, n, copy.difficulty);
+            }
+        }
+        lazyDeletePuzzle(n);
+        *puzzleCountPtr = last;
+        return;
     }
-    *puzzleArrayPtr = realloc(*puzzleArrayPtr, (*puzzleCountPtr - 1) * sizeof(Puzzle));
-    if ((*puzzleCountPtr - 1) > 0 && *puzzleArrayPtr == NULL) {
-        printf("%s\n", translate("ERROR_MEMORY_ALLOCATION"));
-        exit(1);
+    Puzzle *puzzles = *puzzleArrayPtr;
+    PuzzleArrayHeader *header = arrayHeader(puzzles);
+    int last = *puzzleCountPtr - 1;
+
+    if (puzzles[n].meta.indexed) {
+        indexPuzzleMeta(&puzzles[n].meta, -1);
+    }
+    if (!indexesPending) {
+        removeFromDifficultyIndex(n, puzzles[n].difficulty);
+        if (n != last) {
+            renumberInDifficultyIndex(last, n, puzzles[last].difficulty);
+        }
+    }
+    header->positions[puzzles[n].meta.handle] = -1;
+    if (n != last) {
+        puzzles[n] = puzzles[last];
+        header->positions[puzzles[n].meta.handle] = n;
     }
-    *puzzleCountPtr = *puzzleCountPtr - 1;
+    *puzzleCountPtr = last;
 }
\ No newline at end of file
@@ -12,7 +12,75 @@
 #ifndef PUZZLE_H
 #define PUZZLE_H
 
+#include <stddef.h>
+
 #include "dependencies.h"
+#include "./rng.h"
+
+
+/// @brief Solution grids generateUniquePuzzle() tries before settling for more clues than asked
+#define GENERATOR_MAX_ATTEMPTS 1000
+/// @brief Solution grids searched once and transformed into every generated grid
+#define GENERATOR_SEED_GRIDS 64
+/// @brief Seed of the stream the seed grids are drawn from, fixed so generation is reproducible
+#define GENERATOR_SEED_GRID_SEED 0x5EED5EEDULL
+/// @brief Smallest capacity of a puzzle array
+#define PUZZLE_ARRAY_MIN_CAPACITY 16
+/// @brief Bytes in front of the first puzzle of an array, a multiple of the strictest alignment
+#define PUZZLE_ARRAY_HEADER_SIZE \
+    ((sizeof(PuzzleArrayHeader) + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t))
+
+
+/// @brief Digit counts of the user grid per unit, kept up to date by changeValue()
+/// @details Lets play mode check for a solution and find conflicting squares without rescanning the grid
+typedef struct PlayTracker {
+    /// @brief Copies of each digit (index 1-9) in each row
+    unsigned char rowCounts[GRID_SIZE][GRID_SIZE + 1];
+    /// @brief Copies of each digit (index 1-9) in each column
+    unsigned char colCounts[GRID_SIZE][GRID_SIZE + 1];
+    /// @brief Copies of each digit (index 1-9) in each subgrid
+    unsigned char boxCounts[GRID_SIZE][GRID_SIZE + 1];
+    /// @brief Extra copies of digits summed over all units, 0 == no conflicts
+    short conflicts;
+    /// @brief Number of non-empty squares
+    short filled;
+} PlayTracker;
+
+
+/// @brief Per-puzzle metadata kept in sync with the puzzle, feeds #puzzleIndex
+/// @details Widest fields first and flags as bytes, so it adds 24 bytes to every Puzzle
+typedef struct PuzzleMeta {
+    /// @brief Time of the last change to the user grid, 0 == never changed
+    time_t lastModified;
+    /// @brief Wall-clock seconds the last algorithmic solve took, 0 == never solved by the solver
+    double solveTime;
+    /// @brief Identifies the puzzle in its array across deletes, see findPuzzleHandle(); not in lazy mode
+    int handle;
+    /// @brief Number of given squares in the grid
+    unsigned char clueCount;
+    /// @brief 1: user grid is solved
+    unsigned char solved;
+    /// @brief 1: puzzle is counted in #puzzleIndex (it is in the puzzle array)
+    unsigned char indexed;
+} PuzzleMeta;
+
+
+/// @brief Aggregates over every puzzle in the puzzle array, updated incrementally
+/// @details Lets statistics be read in O(1) instead of validating every puzzle
+typedef struct PuzzleIndex {
+    /// @brief Number of indexed puzzles
+    int puzzleCount;
+    /// @brief Number of indexed puzzles with a solved user grid
+    int solvedCount;
+    /// @brief Sum of clue counts
+    long totalClues;
+    /// @brief Number of puzzles with each clue count
+    int clueCounts[GRID_SIZE * GRID_SIZE + 1];
+    /// @brief Sum of solve times of puzzles solved by the solver
+    double totalSolveTime;
+    /// @brief Number of puzzles solved by the solver
+    int timedCount;
+} PuzzleIndex;
 
 
 /// @brief Structure to store data of a single Sudoku puzzle
@@ -23,29 +91,74 @@ typedef struct Puzzle {
     /// @brief The user modified version of the grid
     int userGrid[GRID_SIZE][GRID_SIZE];
     /// @brief Bitmap used to determine which squares are modifiable by user
-    /// @note If 1 == unmodifiable
-    int map[GRID_SIZE][GRID_SIZE];
+    /// @note If 1 == unmodifiable; bytes, as it only holds 0 or 1
+    unsigned char map[GRID_SIZE][GRID_SIZE];
+    /// @brief Difficulty bucket of the grid, see Difficulty in grade.h
+    int difficulty;
+    /// @brief Difficulty score: weighted technique uses plus search effort
+    int rating;
+    /// @brief Digit counts of the user grid, see rebuildPlayTracker()
+    PlayTracker tracker;
+    /// @brief Solved state, clue count and timestamps, see #puzzleIndex
+    PuzzleMeta meta;
 } Puzzle;
 
 
 /// @brief Alias for an array of Puzzle 
+/// @note Arrays that grow or shrink must come from allocatePuzzleArray() or reservePuzzles()
 typedef Puzzle* PuzzleArray;
 
 
+/// @brief Bookkeeping in front of every puzzle array, see allocatePuzzleArray()
+typedef struct PuzzleArrayHeader {
+    /// @brief Puzzles the array holds before it has to grow
+    int capacity;
+    /// @brief Handles given out so far, also the next handle
+    int handleCount;
+    /// @brief Length of positions
+    int handleCapacity;
+    /// @brief Array position of the puzzle of each handle, -1 once deleted
+    int *positions;
+} PuzzleArrayHeader;
+
+
+extern PuzzleIndex puzzleIndex;
+
+
 void generateBitmap(Puzzle *puzzle);
 void generateUserGrid(Puzzle *puzzle);
+void rebuildPlayTracker(Puzzle *puzzle);
+int isPuzzleSolved(const Puzzle *puzzle);
+int isSquareConflicting(const Puzzle *puzzle, int row, int col);
+void refreshPuzzleMeta(Puzzle *puzzle);
+void recordSolveTime(Puzzle *puzzle, double seconds);
+void rebuildPuzzleIndex(PuzzleArray puzzleArray, int puzzleCount);
+void invalidatePuzzleIndexes();
+void ensurePuzzleIndexes(PuzzleArray puzzleArray, int puzzleCount);
+Puzzle *gradedPuzzleAt(PuzzleArray puzzleArray, int n);
+Puzzle *puzzleAt(PuzzleArray puzzleArray, int n);
 int changeValue(Puzzle *puzzle, int x, int y, int value);
-void addPuzzle(Puzzle puzzle, PuzzleArray *puzzleArray, int *puzzleCount);
+PuzzleArray allocatePuzzleArray(int capacity);
+void freePuzzleArray(PuzzleArray puzzleArray);
+int puzzleArrayCapacity(PuzzleArray puzzleArray);
+void reservePuzzles(PuzzleArray *puzzleArray, int puzzleCount, int n);
+void resetPuzzleHandles(PuzzleArray puzzleArray, int puzzleCount);
+int findPuzzleHandle(PuzzleArray puzzleArray, int handle);
+void addPuzzle(const Puzzle *puzzle, PuzzleArray *puzzleArray, int *puzzleCount);
+void appendPuzzles(const Puzzle *puzzles, int n, PuzzleArray *puzzleArray, int *puzzleCount);
 int checkRow(Puzzle puzzle, int row);
 int checkColumn(Puzzle puzzle, int col);
 int checkBox(Puzzle puzzle, int startRow, int startCol);
 int isSudokuSolved(Puzzle puzzle);
 int isSquareSafe(Puzzle *puzzle, int row, int col, int num);
+int solveSudokuUncached(Puzzle *puzzle, int row, int col);
 int solveSudokuUserGrid(Puzzle *puzzle, int row, int col);
 int countSolvedSudokus(int puzzleArrayCount, PuzzleArray puzzleArray);
-void fillUserGridDiagonal(Puzzle* puzzle);
-void setNCluesInUserGrid(Puzzle* puzzle, int n);
+void fillUserGridDiagonal(Puzzle* puzzle, RandomStream *random);
+void drawSolutionGrid(int grid[GRID_SIZE][GRID_SIZE], RandomStream *random);
 void copyUserGridtoGrid(Puzzle *puzzle);
+int removeCluesUniquely(Puzzle *puzzle, int clues, int minimal, RandomStream *random);
+int generateUniquePuzzle(Puzzle *puzzle, int clues, int minimal, RandomStream *random);
 void generatePuzzle(PuzzleArray *puzzleArrayPtr, int *puzzleCountPtr, int clues);
 void deleteNthPuzzle(PuzzleArray *puzzleArrayPtr, int *puzzleCountPtr, int n);
 
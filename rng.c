@@ -0,0 +1,90 @@
+/**
+ * @file rng.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Seedable random number streams for reproducible, thread-safe puzzle generation
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./rng.h"
+
+
+/// @brief Advances a splitmix64 state and returns its next output
+/// @param state State to advance
+/// @return Well-mixed 64-bit value
+static unsigned long long splitMix(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+/// @brief Rotates bits left
+static unsigned long long rotateLeft(unsigned long long x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+
+/// @brief Seeds stream number index of a master seed
+/// @param stream Stream to seed
+/// @param seed Master seed, the same seed and index always give the same stream
+/// @param index Stream number, e.g. the index of the puzzle being generated
+/// @details Seed and index are hashed together before filling the state with splitmix64, so
+/// \ nearby indices give unrelated streams.
+void seedRandomStream(RandomStream *stream, unsigned long long seed, unsigned long long index) {
+    unsigned long long mixer = seed;
+    unsigned long long state = splitMix(&mixer) ^ (index * 0xD1B54A32D192ED03ULL);
+    for (int k = 0; k < 4; ++k) {
+        stream->state[k] = splitMix(&state);
+    }
+}
+
+
+/// @brief Draws the next number of a stream (xoshiro256**)
+/// @param stream Stream to draw from
+/// @return Uniform 64-bit value
+unsigned long long nextRandom(RandomStream *stream) {
+    unsigned long long *s = stream->state;
+    unsigned long long result = rotateLeft(s[1] * 5, 7) * 9;
+    unsigned long long t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+
+/// @brief Draws a number from 0 to bound - 1
+/// @param stream Stream to draw from; NULL draws from rand(), which is neither thread-safe nor seeded per stream
+/// @param bound Number of possible values, at least 1
+/// @return Random number below bound
+int randomBelow(RandomStream *stream, int bound) {
+    if (stream == NULL) {
+        return rand() % bound;
+    }
+    // multiply-shift instead of modulo: no division and no bias worth noticing for small bounds
+    return (int)(((nextRandom(stream) >> 32) * (unsigned long long)bound) >> 32);
+}
+
+
+/// @brief Shuffles an array of ints
+/// @param values Array to shuffle
+/// @param count Length of values
+/// @param random Stream to draw from; NULL uses rand()
+void shuffleValues(int *values, int count, RandomStream *random) {
+    for (int i = count - 1; i > 0; --i) {
+        int j = randomBelow(random, i + 1);
+        int temp = values[i];
+        values[i] = values[j];
+        values[j] = temp;
+    }
+}
@@ -0,0 +1,32 @@
+/**
+ * @file rng.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for rng.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include "./dependencies.h"
+
+
+/// @brief State of one xoshiro256** random number stream
+/// @details Streams share nothing, so every thread can draw from its own without locking
+typedef struct RandomStream {
+    /// @brief Generator state, never all zero
+    unsigned long long state[4];
+} RandomStream;
+
+
+void seedRandomStream(RandomStream *stream, unsigned long long seed, unsigned long long index);
+unsigned long long nextRandom(RandomStream *stream);
+int randomBelow(RandomStream *stream, int bound);
+void shuffleValues(int *values, int count, RandomStream *random);
+
+
+#endif
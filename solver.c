@@ -0,0 +1,603 @@
+/**
+ * @file solver.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Bitmask solver state and search algorithms
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+
+
+/// @brief Squares of every unit: rows first, then columns, then subgrids
+int solverUnits[UNIT_COUNT][GRID_SIZE];
+/// @brief Squares sharing a row, column or subgrid with each square
+int solverPeers[CELL_COUNT][PEER_COUNT];
+/// @brief Set once units and peers have been filled in
+static int tablesReady = 0;
+
+/// @brief Engine used by solveSudokuUserGrid()
+SolverEngine solverEngine = SOLVER_ENGINE_PROPAGATE;
+
+
+/// @brief Finds the subgrid a square belongs to
+/// @param row Row of square
+/// @param col Column of square
+/// @return Subgrid index, counted left to right, top to bottom
+int boxOfSquare(int row, int col) {
+    return (row / SUBGRID_SIZE) * SUBGRID_SIZE + col / SUBGRID_SIZE;
+}
+
+
+/// @brief Builds solver state (values and occupancy masks) from a grid
+/// @param state State to fill
+/// @param grid Grid to read values from
+void loadSolverState(SolverState *state, int grid[GRID_SIZE][GRID_SIZE]) {
+    memset(state, 0, sizeof(*state));
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            if (grid[i][j] > 0) {
+                placeDigit(state, i * GRID_SIZE + j, grid[i][j]);
+            }
+        }
+    }
+}
+
+
+/// @brief Writes solver state values back to a grid
+/// @param state State to read
+/// @param grid Grid to write values to
+void storeSolverState(const SolverState *state, int grid[GRID_SIZE][GRID_SIZE]) {
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            grid[i][j] = state->cells[i * GRID_SIZE + j];
+        }
+    }
+}
+
+
+/// @brief Writes digit to a square and marks it used in the square's row, column, subgrid
+/// @param state State to modify
+/// @param cell Row-major square index
+/// @param num Digit to write (1-9)
+void placeDigit(SolverState *state, int cell, int num) {
+    int row = cell / GRID_SIZE;
+    int col = cell % GRID_SIZE;
+    unsigned int bit = 1u << (num - 1);
+
+    state->cells[cell] = num;
+    state->rowMask[row] |= bit;
+    state->colMask[col] |= bit;
+    state->boxMask[boxOfSquare(row, col)] |= bit;
+}
+
+
+/// @brief Clears a square and frees its digit in the square's row, column, subgrid
+/// @param state State to modify
+/// @param cell Row-major square index
+/// @note Only valid for squares written by placeDigit()
+void removeDigit(SolverState *state, int cell) {
+    int row = cell / GRID_SIZE;
+    int col = cell % GRID_SIZE;
+    unsigned int bit = 1u << (state->cells[cell] - 1);
+
+    state->cells[cell] = 0;
+    state->rowMask[row] &= ~bit;
+    state->colMask[col] &= ~bit;
+    state->boxMask[boxOfSquare(row, col)] &= ~bit;
+}
+
+
+/// @brief Finds which digits can be written to a square
+/// @param state State to check
+/// @param cell Row-major square index
+/// @return Bitmask of digits not yet used in the square's row, column, subgrid
+unsigned int candidateMask(const SolverState *state, int cell) {
+    int row = cell / GRID_SIZE;
+    int col = cell % GRID_SIZE;
+    unsigned int used = state->rowMask[row] | state->colMask[col] | state->boxMask[boxOfSquare(row, col)];
+    return ~used & ALL_DIGITS_MASK;
+}
+
+
+/// @brief Solves solver state with backtracking, squares are visited in row-major order
+/// @param state State to solve
+/// @param cell Call with 0, used by recursive calls
+/// @return 1: solved; 0: unsolvable from this square onwards
+/// @details Digits are tried in ascending order, so the first solution found matches
+/// \ the original isSquareSafe() based search
+int solveSolverState(SolverState *state, int cell) {
+    while (cell < CELL_COUNT && state->cells[cell] > 0) {
+        ++cell;
+    }
+    if (cell == CELL_COUNT) {
+        return 1;
+    }
+
+    unsigned int candidates = candidateMask(state, cell);
+    while (candidates) {
+        int num = __builtin_ctz(candidates) + 1;
+        candidates &= candidates - 1;
+
+        placeDigit(state, cell, num);
+        STAT_NODE(cell, num);
+        if (solveSolverState(state, cell + 1)) {
+            return 1;
+        }
+        removeDigit(state, cell);  // undo the current square for backtracking
+        STAT_UNDO();
+    }
+
+    return 0;
+}
+
+
+/// @brief Solves solver state with backtracking without recursion
+/// @param state State to solve
+/// @param cell Row-major square to start searching from, call with 0
+/// @return 1: solved; 0: unsolvable from this square onwards
+/// @details Visits squares and digits in the same order as solveSolverState(), so both find the
+/// \ same solution. Uses a fixed-size stack of empty squares and the digits left to try at each,
+/// \ so stack usage does not depend on the search. Row, column and subgrid of every stack entry
+/// \ are looked up once up front instead of on every move.
+int solveSolverStateIterative(SolverState *state, int cell) {
+    int emptyCells[CELL_COUNT];
+    unsigned int *rowMasks[CELL_COUNT], *colMasks[CELL_COUNT], *boxMasks[CELL_COUNT];
+    unsigned int untried[CELL_COUNT];
+    unsigned int placed[CELL_COUNT];
+    int emptyCount = 0;
+
+    for (int i = cell; i < CELL_COUNT; ++i) {
+        if (state->cells[i] == 0) {
+            int row = i / GRID_SIZE;
+            int col = i % GRID_SIZE;
+            emptyCells[emptyCount] = i;
+            rowMasks[emptyCount] = &state->rowMask[row];
+            colMasks[emptyCount] = &state->colMask[col];
+            boxMasks[emptyCount] = &state->boxMask[boxOfSquare(row, col)];
+            emptyCount++;
+        }
+    }
+    if (emptyCount == 0) {
+        return 1;
+    }
+
+    int depth = 0;
+    untried[0] = ~(*rowMasks[0] | *colMasks[0] | *boxMasks[0]) & ALL_DIGITS_MASK;
+    while (1) {
+        if (untried[depth] == 0) {
+            if (--depth < 0) {
+                return 0;
+            }
+            // undo the square for backtracking
+            *rowMasks[depth] &= ~placed[depth];
+            *colMasks[depth] &= ~placed[depth];
+            *boxMasks[depth] &= ~placed[depth];
+            state->cells[emptyCells[depth]] = 0;
+            STAT_UNDO();
+            continue;
+        }
+
+        unsigned int bit = untried[depth] & -untried[depth];
+        untried[depth] &= untried[depth] - 1;
+        placed[depth] = bit;
+        *rowMasks[depth] |= bit;
+        *colMasks[depth] |= bit;
+        *boxMasks[depth] |= bit;
+        state->cells[emptyCells[depth]] = __builtin_ctz(bit) + 1;
+        STAT_NODE(emptyCells[depth], __builtin_ctz(bit) + 1);
+
+        if (++depth == emptyCount) {
+            return 1;
+        }
+        untried[depth] = ~(*rowMasks[depth] | *colMasks[depth] | *boxMasks[depth]) & ALL_DIGITS_MASK;
+    }
+}
+
+
+/// @brief Fills in the unit and peer lookup tables used by the propagating solver
+/// @note Called automatically by loadPropagationState(), safe to call more than once
+void initSolverTables() {
+    if (tablesReady) {
+        return;
+    }
+
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            solverUnits[i][j] = i * GRID_SIZE + j;
+            solverUnits[GRID_SIZE + i][j] = j * GRID_SIZE + i;
+            int row = (i / SUBGRID_SIZE) * SUBGRID_SIZE + j / SUBGRID_SIZE;
+            int col = (i % SUBGRID_SIZE) * SUBGRID_SIZE + j % SUBGRID_SIZE;
+            solverUnits[2 * GRID_SIZE + i][j] = row * GRID_SIZE + col;
+        }
+    }
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int row = cell / GRID_SIZE;
+        int col = cell % GRID_SIZE;
+        int count = 0;
+        for (int other = 0; other < CELL_COUNT; ++other) {
+            int otherRow = other / GRID_SIZE;
+            int otherCol = other % GRID_SIZE;
+            if (other != cell && (otherRow == row || otherCol == col || \
+                boxOfSquare(otherRow, otherCol) == boxOfSquare(row, col))) {
+                solverPeers[cell][count++] = other;
+            }
+        }
+    }
+
+    tablesReady = 1;
+}
+
+
+/// @brief Builds propagating solver state from a grid in any representation
+/// @param state State to fill
+/// @param readCell Reads a square of grid
+/// @param grid Grid to read values from
+/// @return 1: loaded; 0: grid values contradict each other
+int loadPropagationCells(PropagationState *state, CellReader readCell, const void *grid) {
+    initSolverTables();
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        state->cells[cell] = 0;
+        state->candidates[cell] = ALL_DIGITS_MASK;
+    }
+    state->emptyCount = CELL_COUNT;
+
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int num = readCell(grid, cell);
+        if (num <= 0) {
+            continue;
+        }
+        if (num > GRID_SIZE || !(state->candidates[cell] & (1u << (num - 1)))) {
+            return 0;
+        }
+        if (!assignDigit(state, cell, num)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Reads a square of an int grid, see #CellReader
+static int readGridCell(const void *grid, int cell) {
+    return ((const int (*)[GRID_SIZE])grid)[cell / GRID_SIZE][cell % GRID_SIZE];
+}
+
+
+/// @brief Builds propagating solver state from a grid
+/// @param state State to fill
+/// @param grid Grid to read values from
+/// @return 1: loaded; 0: grid values contradict each other
+int loadPropagationState(PropagationState *state, int grid[GRID_SIZE][GRID_SIZE]) {
+    return loadPropagationCells(state, readGridCell, grid);
+}
+
+
+/// @brief Writes propagating solver state values back to a grid
+/// @param state State to read
+/// @param grid Grid to write values to
+void storePropagationState(const PropagationState *state, int grid[GRID_SIZE][GRID_SIZE]) {
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            grid[i][j] = state->cells[i * GRID_SIZE + j];
+        }
+    }
+}
+
+
+/// @brief Writes digit to a square and removes it from the candidates of its peers
+/// @param state State to modify
+/// @param cell Row-major square index, must be empty
+/// @param num Digit to write (1-9)
+/// @return 1: success; 0: some peer was left without candidates
+int assignDigit(PropagationState *state, int cell, int num) {
+    unsigned short bit = 1u << (num - 1);
+
+    state->cells[cell] = num;
+    state->candidates[cell] = 0;
+    state->emptyCount--;
+
+    for (int i = 0; i < PEER_COUNT; ++i) {
+        int peer = solverPeers[cell][i];
+        if (state->candidates[peer] & bit) {
+            state->candidates[peer] &= ~bit;
+            if (state->candidates[peer] == 0) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Finds the digits no peer of a square holds
+/// @param state State to check
+/// @param cell Row-major square index
+/// @return Bitmask of digits, bit 0 == digit 1
+static unsigned int freeDigits(const PropagationState *state, int cell) {
+    unsigned int used = 0;
+    for (int i = 0; i < PEER_COUNT; ++i) {
+        int num = state->cells[solverPeers[cell][i]];
+        if (num > 0) {
+            used |= 1u << (num - 1);
+        }
+    }
+    return ~used & ALL_DIGITS_MASK;
+}
+
+
+/// @brief Clears a square and gives its digit back to the peers it was taken from
+/// @param state State to modify, must not have been propagated or searched
+/// @param cell Row-major square index, must hold a digit
+/// @details Candidates of the square and its empty peers are rebuilt from their peers, so the
+/// \ state matches loadPropagationState() of the grid without that square.
+void clearDigit(PropagationState *state, int cell) {
+    state->cells[cell] = 0;
+    state->candidates[cell] = freeDigits(state, cell);
+    state->emptyCount++;
+
+    for (int i = 0; i < PEER_COUNT; ++i) {
+        int peer = solverPeers[cell][i];
+        if (state->cells[peer] == 0) {
+            state->candidates[peer] = freeDigits(state, peer);
+        }
+    }
+}
+
+
+/// @brief Applies naked singles and hidden singles until nothing changes
+/// @param state State to modify
+/// @return 1: no contradiction found; 0: state cannot be solved
+/// @details Naked single: square with one candidate left.
+/// \ Hidden single: digit that fits in only one square of a unit.
+int propagate(PropagationState *state) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+
+        for (int cell = 0; cell < CELL_COUNT; ++cell) {
+            unsigned int candidates = state->candidates[cell];
+            if (candidates && !(candidates & (candidates - 1))) {
+                if (!assignDigit(state, cell, __builtin_ctz(candidates) + 1)) {
+                    return 0;
+                }
+                STAT_PROPAGATE();
+                changed = 1;
+            }
+        }
+
+        for (int unit = 0; unit < UNIT_COUNT; ++unit) {
+            unsigned int once = 0, twice = 0, placed = 0;
+            for (int k = 0; k < GRID_SIZE; ++k) {
+                int cell = solverUnits[unit][k];
+                if (state->cells[cell] > 0) {
+                    placed |= 1u << (state->cells[cell] - 1);
+                }
+                else {
+                    twice |= once & state->candidates[cell];
+                    once |= state->candidates[cell];
+                }
+            }
+            if ((once | placed) != ALL_DIGITS_MASK) {
+                return 0;
+            }
+
+            unsigned int hidden = once & ~twice;
+            while (hidden) {
+                unsigned int bit = hidden & -hidden;
+                hidden &= hidden - 1;
+
+                int target = -1;
+                for (int k = 0; k < GRID_SIZE; ++k) {
+                    if (state->candidates[solverUnits[unit][k]] & bit) {
+                        target = solverUnits[unit][k];
+                        break;
+                    }
+                }
+                if (target < 0 || !assignDigit(state, target, __builtin_ctz(bit) + 1)) {
+                    return 0;
+                }
+                STAT_PROPAGATE();
+                changed = 1;
+            }
+        }
+    }
+    return 1;
+}
+
+
+/// @brief Finds the empty square with the fewest candidates (minimum remaining values)
+/// @param state State to check
+/// @return Row-major square index; -1 if there are no empty squares
+int findMostConstrainedSquare(const PropagationState *state) {
+    int best = -1;
+    int bestCount = GRID_SIZE + 1;
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        if (state->cells[cell] > 0) {
+            continue;
+        }
+        int count = __builtin_popcount(state->candidates[cell]);
+        if (count < bestCount) {
+            best = cell;
+            bestCount = count;
+            if (count <= 2) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+
+/// @brief Solves propagating solver state
+/// @param state State to solve, holds the solution if one is found
+/// @return 1: solved; 0: unsolvable
+/// @details Propagates, then branches on the most constrained square. Each branch works on
+/// \ a copy of the state, so backtracking is simply dropping the copy.
+int solvePropagationState(PropagationState *state) {
+    if (!propagate(state)) {
+        return 0;
+    }
+    if (state->emptyCount == 0) {
+        return 1;
+    }
+
+    int cell = findMostConstrainedSquare(state);
+    unsigned int candidates = state->candidates[cell];
+    while (candidates) {
+        int num = __builtin_ctz(candidates) + 1;
+        candidates &= candidates - 1;
+
+        PropagationState next = *state;
+        STAT_NODE(cell, num);
+        if (assignDigit(&next, cell, num) && solvePropagationState(&next)) {
+            *state = next;
+            return 1;
+        }
+        STAT_UNDO();
+    }
+    return 0;
+}
+
+
+/// @brief Solves user grid of puzzle using constraint propagation
+/// @param puzzle Puzzle to solve
+/// @return 0: unsolvable; 1: solved, user grid holds the solution
+/// @note User grid is left unchanged if no solution is found
+int solveSudokuPropagation(Puzzle *puzzle) {
+    PropagationState state;
+    if (!loadPropagationState(&state, puzzle->userGrid)) {
+        return 0;
+    }
+    STAT_PHASE(SOLVER_PHASE_SEARCH);
+    if (!solvePropagationState(&state)) {
+        return 0;
+    }
+    STAT_PHASE(SOLVER_PHASE_STORE);
+    storePropagationState(&state, puzzle->userGrid);
+    return 1;
+}
+
+
+/// @brief Counts solutions of propagating solver state, stopping early
+/// @param state State to search, left in an undefined state
+/// @param limit Stop once this many solutions are found
+/// @return Number of solutions found, at most limit
+/// @details Same search as solvePropagationState(), except it keeps going after a solution
+int countPropagationSolutions(PropagationState *state, int limit) {
+    if (!propagate(state)) {
+        return 0;
+    }
+    if (state->emptyCount == 0) {
+        return 1;
+    }
+
+    int count = 0;
+    int cell = findMostConstrainedSquare(state);
+    unsigned int candidates = state->candidates[cell];
+    while (candidates && count < limit) {
+        int num = __builtin_ctz(candidates) + 1;
+        candidates &= candidates - 1;
+
+        PropagationState next = *state;
+        STAT_NODE(cell, num);
+        if (assignDigit(&next, cell, num)) {
+            count += countPropagationSolutions(&next, limit - count);
+        }
+        STAT_UNDO();
+    }
+    return count;
+}
+
+
+/// @brief Counts solutions of the puzzle user grid, up to a limit
+/// @param puzzle Puzzle to check, left unchanged
+/// @param limit Stop once this many solutions are found
+/// @return Number of solutions found, at most limit; 0 if user grid contradicts itself
+/// @note A limit of 2 is enough to tell apart unsolvable, unique and ambiguous puzzles
+int countSolutions(Puzzle *puzzle, int limit) {
+    PropagationState state;
+    if (limit <= 0 || !loadPropagationState(&state, puzzle->userGrid)) {
+        return 0;
+    }
+    return countPropagationSolutions(&state, limit);
+}
+
+
+/// @brief Checks if propagating solver state has a solution in which a square does not hold a given digit
+/// @param state State to search, left in an undefined state; square must be empty
+/// @param cell Row-major square
+/// @param num Digit the square may not hold
+/// @return 1: such a solution exists; 0: every solution has num in the square, or there is none
+/// @details If the state plus num in the square has exactly one solution, this tells whether the
+/// \ state alone still has exactly one. It only looks for a single solution, so it is cheaper than
+/// \ counting up to two.
+int hasSolutionAvoiding(PropagationState *state, int cell, int num) {
+    state->candidates[cell] &= ~(1u << (num - 1));
+    if (state->candidates[cell] == 0) {
+        return 0;
+    }
+    return solvePropagationState(state);
+}
+
+
+/// @brief Checks if the puzzle user grid has exactly one solution
+/// @param puzzle Puzzle to check, left unchanged
+/// @return 1: unique solution; 0: unsolvable or ambiguous
+int hasUniqueSolution(Puzzle *puzzle) {
+    return countSolutions(puzzle, 2) == 1;
+}
+
+/// @brief Finds the display string key of a solver engine
+/// @param engine Engine to name
+/// @return Key to be converted by translate()
+char* solverEngineKey(SolverEngine engine) {
+    switch (engine) {
+        case SOLVER_ENGINE_BACKTRACK:
+            return "SOLVER_ENGINE_BACKTRACK";
+        case SOLVER_ENGINE_PROPAGATE:
+            return "SOLVER_ENGINE_PROPAGATE";
+        case SOLVER_ENGINE_DLX:
+            return "SOLVER_ENGINE_DLX";
+        case SOLVER_ENGINE_BITBOARD:
+            return "SOLVER_ENGINE_BITBOARD";
+        case SOLVER_ENGINE_ITERATIVE:
+            return "SOLVER_ENGINE_ITERATIVE";
+        case SOLVER_ENGINE_PARALLEL:
+            return "SOLVER_ENGINE_PARALLEL";
+        default:
+            return "SOLVER_ENGINE_UNKNOWN";
+    }
+}
+
+
+/// @brief Engine names used on the command line, in #SolverEngine order; not translated
+static const char *solverEngineNames[SOLVER_ENGINE_COUNT] = {"backtrack", "propagate", "dlx", "bitboard", "iterative", "parallel"};
+
+
+/// @brief Finds the command-line name of a solver engine
+/// @param engine Engine to name
+/// @return Name such as "dlx", also used in machine-readable output
+const char* solverEngineName(SolverEngine engine) {
+    return (engine >= 0 && engine < SOLVER_ENGINE_COUNT) ? solverEngineNames[engine] : "unknown";
+}
+
+
+/// @brief Finds a solver engine by its command-line name
+/// @param name Name as returned by solverEngineName()
+/// @return Engine; #SOLVER_ENGINE_COUNT if no engine has that name
+SolverEngine findSolverEngine(const char *name) {
+    for (int e = 0; e < SOLVER_ENGINE_COUNT; ++e) {
+        if (strcmp(name, solverEngineNames[e]) == 0) {
+            return e;
+        }
+    }
+    return SOLVER_ENGINE_COUNT;
+}
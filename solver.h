@@ -0,0 +1,117 @@
+/**
+ * @file solver.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for solver.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./instrument.h"
+
+
+/// @brief Number of squares in the grid
+#define CELL_COUNT (GRID_SIZE * GRID_SIZE)
+/// @brief Candidate mask with a bit set for every digit
+/// @note Digit n is stored in bit (n - 1)
+#define ALL_DIGITS_MASK ((1u << GRID_SIZE) - 1)
+/// @brief Number of units (rows, columns, subgrids) in the grid
+#define UNIT_COUNT (3 * GRID_SIZE)
+/// @brief Number of squares sharing a unit with any given square
+#define PEER_COUNT (3 * GRID_SIZE - 2 * SUBGRID_SIZE - 1)
+
+
+/// @brief Search state used by the solvers
+/// @details Keeps occupancy bitmasks for every row, column and subgrid, so checking
+/// \ whether a digit fits in a square is a single AND instead of rescanning the grid
+typedef struct SolverState {
+    /// @brief Square values in row-major order, 0 == empty
+    int cells[CELL_COUNT];
+    /// @brief Digits already used in each row
+    unsigned int rowMask[GRID_SIZE];
+    /// @brief Digits already used in each column
+    unsigned int colMask[GRID_SIZE];
+    /// @brief Digits already used in each subgrid
+    unsigned int boxMask[GRID_SIZE];
+} SolverState;
+
+
+/// @brief Search state used by the propagating solver
+/// @details Small enough to be copied on every branch, which is how the search undoes its moves
+typedef struct PropagationState {
+    /// @brief Square values in row-major order, 0 == empty
+    unsigned char cells[CELL_COUNT];
+    /// @brief Digits that can still be written to each square, 0 for filled squares
+    unsigned short candidates[CELL_COUNT];
+    /// @brief Number of empty squares left
+    int emptyCount;
+} PropagationState;
+
+
+/// @brief Reads a square of a grid kept in any representation, see loadPropagationCells()
+/// @param grid Grid to read
+/// @param cell Row-major square index
+/// @return Square value, 0 == empty
+typedef int (*CellReader)(const void *grid, int cell);
+
+
+/// @brief Algorithms solveSudokuUserGrid() can use
+typedef enum SolverEngine {
+    /// @brief Row-major backtracking on occupancy bitmasks
+    SOLVER_ENGINE_BACKTRACK,
+    /// @brief Naked/hidden singles with minimum remaining values branching
+    SOLVER_ENGINE_PROPAGATE,
+    /// @brief Dancing Links exact cover search
+    SOLVER_ENGINE_DLX,
+    /// @brief Per-digit SIMD bitboard planes
+    SOLVER_ENGINE_BITBOARD,
+    /// @brief Row-major backtracking on an explicit stack, same results as SOLVER_ENGINE_BACKTRACK
+    SOLVER_ENGINE_ITERATIVE,
+    /// @brief Propagating search split over every core
+    SOLVER_ENGINE_PARALLEL,
+    /// @brief Number of engines, not an engine
+    SOLVER_ENGINE_COUNT
+} SolverEngine;
+
+
+extern SolverEngine solverEngine;
+extern int solverUnits[UNIT_COUNT][GRID_SIZE];
+extern int solverPeers[CELL_COUNT][PEER_COUNT];
+
+
+int boxOfSquare(int row, int col);
+void loadSolverState(SolverState *state, int grid[GRID_SIZE][GRID_SIZE]);
+void storeSolverState(const SolverState *state, int grid[GRID_SIZE][GRID_SIZE]);
+void placeDigit(SolverState *state, int cell, int num);
+void removeDigit(SolverState *state, int cell);
+unsigned int candidateMask(const SolverState *state, int cell);
+int solveSolverState(SolverState *state, int cell);
+int solveSolverStateIterative(SolverState *state, int cell);
+
+void initSolverTables();
+int loadPropagationCells(PropagationState *state, CellReader readCell, const void *grid);
+int loadPropagationState(PropagationState *state, int grid[GRID_SIZE][GRID_SIZE]);
+void storePropagationState(const PropagationState *state, int grid[GRID_SIZE][GRID_SIZE]);
+int assignDigit(PropagationState *state, int cell, int num);
+void clearDigit(PropagationState *state, int cell);
+int propagate(PropagationState *state);
+int findMostConstrainedSquare(const PropagationState *state);
+int solvePropagationState(PropagationState *state);
+int solveSudokuPropagation(Puzzle *puzzle);
+int countPropagationSolutions(PropagationState *state, int limit);
+int countSolutions(Puzzle *puzzle, int limit);
+int hasUniqueSolution(Puzzle *puzzle);
+int hasSolutionAvoiding(PropagationState *state, int cell, int num);
+char* solverEngineKey(SolverEngine engine);
+const char* solverEngineName(SolverEngine engine);
+SolverEngine findSolverEngine(const char *name);
+
+
+#endif
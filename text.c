@@ -0,0 +1,387 @@
+/**
+ * @file text.c
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Streaming import and export of the text format, one puzzle per line
+ * @details A 9x9 puzzle is 81 characters. 4x4, 16x16 and 25x25 puzzles are 16, 256 and 625
+ * \ characters, their size is told by the line length. Digits above 9 are the letters A-P.
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./solver.h"
+#include "./lazy.h"
+#include "./text.h"
+#include "./ui.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/// @brief Checks if a character can stand for a square
+static inline int isSquareChar(char c) {
+    return c == '.' || (c >= '0' && c <= '9');
+}
+
+
+#if defined(__SSE2__)
+/// @brief Widens sixteen byte values and stores them as ints
+static inline void storeWidened(int *out, __m128i bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128((__m128i *)(out + 4), _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128((__m128i *)(out + 8), _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128((__m128i *)(out + 12), _mm_unpackhi_epi16(hi, zero));
+}
+#endif
+
+
+/// @brief Parses an 81-character puzzle line, '.' or '0' for empty squares
+/// @param line Line without its newline
+/// @param length Line length, at least #CELL_COUNT characters must be readable
+/// @param puzzle Puzzle whose grid, user grid (a copy of the grid) and bitmap are written,
+/// \ only valid if the line is accepted
+/// @return 1: puzzle read; 0: not a puzzle line
+/// @details Anything after the 81 squares is ignored if it is separated from them, so
+/// \ "puzzle,solution" and "puzzle rating" lines are read as well. Sixteen squares are
+/// \ checked and widened at once with SSE2, all three grids are written from the same registers;
+/// \ the bitmap is stored as bytes without widening.
+int parsePuzzleLine(const char *line, size_t length, Puzzle *puzzle) {
+    if (length < CELL_COUNT || (length > CELL_COUNT && isSquareChar(line[CELL_COUNT]))) {
+        return 0;
+    }
+    int *grid = &puzzle->grid[0][0];
+    int *userGrid = &puzzle->userGrid[0][0];
+    unsigned char *map = &puzzle->map[0][0];
+    int cell = 0;
+
+#if defined(__SSE2__)
+    const __m128i digitZero = _mm_set1_epi8('0');
+    const __m128i dot = _mm_set1_epi8('.' - '0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i one = _mm_set1_epi8(1);
+    for (; cell + 16 <= CELL_COUNT; cell += 16) {
+        __m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)(line + cell)), digitZero);
+        v = _mm_andnot_si128(_mm_cmpeq_epi8(v, dot), v);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, nine), v)) != 0xFFFF) {
+            return 0;
+        }
+        storeWidened(grid + cell, v);
+        storeWidened(userGrid + cell, v);
+        _mm_storeu_si128((__m128i *)(map + cell), _mm_min_epu8(v, one));
+    }
+#endif
+
+    for (; cell < CELL_COUNT; ++cell) {
+        if (!isSquareChar(line[cell])) {
+            return 0;
+        }
+        grid[cell] = line[cell] == '.' ? 0 : line[cell] - '0';
+        userGrid[cell] = grid[cell];
+        map[cell] = grid[cell] != 0;
+    }
+    return 1;
+}
+
+
+/// @brief Writes a grid as 81 characters, #TEXT_EMPTY_SQUARE for empty squares
+/// @param grid Grid to write, values 0-9; values out of range are written as empty squares
+/// @param line Buffer of at least #CELL_COUNT characters, no newline or terminator is added
+void formatPuzzleLine(const int grid[GRID_SIZE][GRID_SIZE], char *line) {
+    const int *cells = &grid[0][0];
+    int cell = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i digitZero = _mm_set1_epi8('0');
+    const __m128i empty = _mm_set1_epi8(TEXT_EMPTY_SQUARE);
+    for (; cell + 16 <= CELL_COUNT; cell += 16) {
+        __m128i a = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)(cells + cell)), \
+            _mm_loadu_si128((const __m128i *)(cells + cell + 4)));
+        __m128i b = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)(cells + cell + 8)), \
+            _mm_loadu_si128((const __m128i *)(cells + cell + 12)));
+        // negative values saturate to 0, values above 255 to 255
+        __m128i v = _mm_packus_epi16(a, b);
+        __m128i isDigit = _mm_andnot_si128(_mm_cmpeq_epi8(v, zero), _mm_cmpeq_epi8(_mm_min_epu8(v, nine), v));
+        v = _mm_add_epi8(v, digitZero);
+        v = _mm_or_si128(_mm_and_si128(isDigit, v), _mm_andnot_si128(isDigit, empty));
+        _mm_storeu_si128((__m128i *)(line + cell), v);
+    }
+#endif
+
+    for (; cell < CELL_COUNT; ++cell) {
+        line[cell] = (cells[cell] < 1 || cells[cell] > 9) ? TEXT_EMPTY_SQUARE : '0' + cells[cell];
+    }
+}
+
+
+/// @brief Finds the value of a square character of a sized line
+/// @return Value, 0 for empty; -1 if c is not a square character
+static inline int sizedSquareValue(char c) {
+    if (c == '.' || (c >= '0' && c <= '9')) {
+        return c == '.' ? 0 : c - '0';
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+
+/// @brief Parses a 4x4, 16x16 or 25x25 puzzle line, '.' or '0' for empty squares, A-P for 10-25
+/// @param line Line without its newline
+/// @param length Line length
+/// @param cells Receives size * size values in row-major order, at least #TEXT_MAX_SQUARES long
+/// @return Grid side length (4, 16 or 25); 0: not a puzzle line of those sizes
+/// @details The size is told by the number of square characters before the end of the line or
+/// \ a separator, like parsePuzzleLine() anything after a separator is ignored.
+int parseSizedLine(const char *line, size_t length, int *cells) {
+    size_t squares = 0;
+    while (squares < length && squares <= TEXT_MAX_SQUARES && sizedSquareValue(line[squares]) >= 0) {
+        ++squares;
+    }
+    int size = squares == 16 ? 4 : squares == 256 ? 16 : squares == 625 ? 25 : 0;
+    if (size == 0) {
+        return 0;
+    }
+    for (size_t cell = 0; cell < squares; ++cell) {
+        cells[cell] = sizedSquareValue(line[cell]);
+        if (cells[cell] > size) {
+            return 0;
+        }
+    }
+    return size;
+}
+
+
+/// @brief Writes a grid of any supported size as one character per square, see parseSizedLine()
+/// @param cells Grid to write, size * size values in row-major order
+/// @param size Grid side length
+/// @param line Buffer of at least size * size characters, no newline or terminator is added
+void formatSizedLine(const int *cells, int size, char *line) {
+    for (int cell = 0; cell < size * size; ++cell) {
+        int value = cells[cell];
+        line[cell] = value == 0 ? TEXT_EMPTY_SQUARE : value <= 9 ? '0' + value : 'A' + value - 10;
+    }
+}
+
+
+/// @brief Reads a text stream in #TEXT_BUFFER_SIZE chunks and hands every puzzle line to a handler
+/// @param file Stream to read, e.g. stdin; left open
+/// @param handlers Called for every puzzle and rejected line, see PuzzleTextHandlers
+/// @param context Passed to the handlers
+/// @param stats Receives accepted and rejected line counts, can be NULL
+/// @details Lines are found with memchr() in the chunk and parsed in place, lines cut by the end
+/// \ of a chunk are moved to the front of the buffer before the next read. Lines longer than the
+/// \ buffer are rejected.
+void streamPuzzleFile(FILE *file, const PuzzleTextHandlers *handlers, void *context, TextImportStats *stats) {
+    TextImportStats counts = {0, 0};
+    char *buffer = malloc(TEXT_BUFFER_SIZE);
+    Puzzle *puzzle = malloc(sizeof(Puzzle));
+    int *cells = malloc(TEXT_MAX_SQUARES * sizeof(int));
+    if (buffer == NULL || puzzle == NULL || cells == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    memset(puzzle, 0, sizeof(*puzzle));
+
+    size_t filled = 0;
+    int skipping = 0, stop = 0, end = 0;
+    while (!stop && !end) {
+        size_t got = fread(buffer + filled, 1, TEXT_BUFFER_SIZE - filled, file);
+        filled += got;
+        end = (got == 0);
+
+        size_t start = 0;
+        while (!stop && start < filled) {
+            char *newline = memchr(buffer + start, '\n', filled - start);
+            if (newline == NULL && !end) {
+                break;
+            }
+            size_t lineEnd = newline != NULL ? (size_t)(newline - buffer) : filled;
+            const char *line = buffer + start;
+            size_t length = lineEnd - start;
+            start = lineEnd + 1;
+
+            if (skipping) {
+                skipping = 0;
+                continue;
+            }
+            if (length > 0 && line[length - 1] == '\r') {
+                --length;
+            }
+            if (length == 0 || line[0] == '#') {
+                continue;
+            }
+            int size;
+            if (parsePuzzleLine(line, length, puzzle)) {
+                counts.accepted++;
+                stop = handlers->puzzle != NULL && !handlers->puzzle(puzzle, context);
+            }
+            else if (handlers->sized != NULL && (size = parseSizedLine(line, length, cells)) != 0) {
+                counts.accepted++;
+                stop = !handlers->sized(cells, size, context);
+            }
+            else {
+                counts.rejected++;
+                stop = handlers->rejected != NULL && !handlers->rejected(line, length, context);
+            }
+        }
+
+        if (start >= filled) {
+            filled = 0;
+        }
+        else if (start > 0) {
+            memmove(buffer, buffer + start, filled - start);
+            filled -= start;
+        }
+        else if (filled == TEXT_BUFFER_SIZE) {
+            // a single line fills the buffer, drop it up to its newline
+            if (!skipping) {
+                counts.rejected++;
+                stop = handlers->rejected != NULL && !handlers->rejected(buffer, filled, context);
+            }
+            filled = 0;
+            skipping = 1;
+        }
+    }
+
+    free(cells);
+    free(puzzle);
+    free(buffer);
+    if (stats != NULL) {
+        *stats = counts;
+    }
+}
+
+
+/// @brief Reads a text file and hands every puzzle line to a handler, see streamPuzzleFile()
+/// @param filename File to read
+/// @param handlers Called for every puzzle and rejected line, see PuzzleTextHandlers
+/// @param context Passed to the handlers
+/// @param stats Receives accepted and rejected line counts, can be NULL
+/// @return 1: file read; 0: unable to open the file
+int streamPuzzleText(const char *filename, const PuzzleTextHandlers *handlers, void *context, TextImportStats *stats) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    streamPuzzleFile(file, handlers, context, stats);
+    fclose(file);
+    return 1;
+}
+
+
+/// @brief Destination of importPuzzleText(), puzzles are collected and appended in batches
+typedef struct TextImport {
+    PuzzleArray *puzzleArray;
+    int *puzzleCount;
+    Puzzle *batch;
+    int batchCount;
+} TextImport;
+
+
+/// @brief Handler of importPuzzleText()
+static int collectPuzzle(Puzzle *puzzle, void *context) {
+    TextImport *import = context;
+    import->batch[import->batchCount++] = *puzzle;
+    if (import->batchCount == TEXT_IMPORT_BATCH) {
+        appendPuzzles(import->batch, import->batchCount, import->puzzleArray, import->puzzleCount);
+        import->batchCount = 0;
+    }
+    return 1;
+}
+
+
+/// @brief Appends every puzzle of a text file to a puzzle array
+/// @param filename File to read, one 81-character puzzle per line
+/// @param puzzleArray Array to append to, NULL in lazy mode
+/// @param puzzleCount Array size, incremented for every puzzle
+/// @param stats Receives accepted and rejected line counts, can be NULL
+/// @return 1: file read; 0: unable to open the file
+/// @note Puzzles are indexed like addPuzzle() and graded when the difficulty index is first used
+int importPuzzleText(const char *filename, PuzzleArray *puzzleArray, int *puzzleCount, TextImportStats *stats) {
+    TextImport import = {puzzleArray, puzzleCount, malloc(TEXT_IMPORT_BATCH * sizeof(Puzzle)), 0};
+    if (import.batch == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+    PuzzleTextHandlers handlers = {collectPuzzle, NULL, NULL};
+    int opened = streamPuzzleText(filename, &handlers, &import, stats);
+    appendPuzzles(import.batch, import.batchCount, puzzleArray, puzzleCount);
+    free(import.batch);
+    return opened;
+}
+
+
+/// @brief Output buffer of exportPuzzleText()
+typedef struct TextExport {
+    FILE *file;
+    char *buffer;
+    size_t filled;
+    int userGrids;
+    int failed;
+} TextExport;
+
+
+/// @brief Appends a puzzle line to the export buffer, writing the buffer out when full
+static void exportPuzzle(TextExport *export, const Puzzle *puzzle) {
+    if (export->filled + CELL_COUNT + 1 > TEXT_BUFFER_SIZE) {
+        export->failed |= fwrite(export->buffer, 1, export->filled, export->file) != export->filled;
+        export->filled = 0;
+    }
+    formatPuzzleLine(export->userGrids ? puzzle->userGrid : puzzle->grid, export->buffer + export->filled);
+    export->buffer[export->filled + CELL_COUNT] = '\n';
+    export->filled += CELL_COUNT + 1;
+}
+
+
+/// @brief Visitor of exportPuzzleText() in lazy mode
+static void exportLazyPuzzle(int index, Puzzle *puzzle, int materialised, void *context) {
+    exportPuzzle(context, puzzle);
+}
+
+
+/// @brief Writes every puzzle of an array to a text file, one 81-character line each
+/// @param filename File to write, overwritten
+/// @param puzzleArray Array to export, NULL in lazy mode
+/// @param puzzleCount Array size
+/// @param userGrids 1: write the user grids (progress or solutions); 0: write the puzzles
+/// @return Number of puzzles written; -1 if the file could not be opened or written
+long exportPuzzleText(const char *filename, PuzzleArray puzzleArray, int puzzleCount, int userGrids) {
+    TextExport export = {fopen(filename, "wb"), malloc(TEXT_BUFFER_SIZE), 0, userGrids, 0};
+    if (export.file == NULL) {
+        free(export.buffer);
+        return -1;
+    }
+    if (export.buffer == NULL) {
+        fprintf(stderr, "%s", translate("ERROR_MEMORY_ALLOCATION"));
+        exit(1);
+    }
+
+    if (puzzleArray == NULL && lazyStoreActive()) {
+        // decode records one at a time instead of materialising the whole save
+        forEachLazyPuzzle(exportLazyPuzzle, &export);
+    }
+    else {
+        for (int i = 0; i < puzzleCount; ++i) {
+            exportPuzzle(&export, &puzzleArray[i]);
+        }
+    }
+
+    export.failed |= fwrite(export.buffer, 1, export.filled, export.file) != export.filled;
+    export.failed |= fclose(export.file) != 0;
+    free(export.buffer);
+    return export.failed ? -1 : puzzleCount;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file text.h
+ * @author Kajus Zakaras (kajus.z@tuta.io)
+ * @brief Header file for text.c
+ * @version 1.00
+ * @date 2024-01-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TEXT_H
+#define TEXT_H
+
+#include "./dependencies.h"
+#include "./puzzle.h"
+#include "./kernels.h"
+
+
+/// @brief Bytes read from or written to a text file at once
+#define TEXT_BUFFER_SIZE (1 << 20)
+/// @brief Puzzles parsed before they are appended to an array together
+#define TEXT_IMPORT_BATCH 1024
+/// @brief Character written for empty squares
+#define TEXT_EMPTY_SQUARE '.'
+/// @brief Longest puzzle line, a 25x25 grid
+#define TEXT_MAX_SQUARES (MAX_KERNEL_SIZE * MAX_KERNEL_SIZE)
+
+
+/// @brief Counts of a text import
+typedef struct TextImportStats {
+    /// @brief Lines parsed into puzzles
+    long accepted;
+    /// @brief Non-empty lines that are not a puzzle, comment lines (starting with '#') are not counted
+    long rejected;
+} TextImportStats;
+
+
+/// @brief Called by streamPuzzleFile() for every 9x9 puzzle read
+/// @details puzzle has grid, user grid and bitmap set; it is reused for the next line after the call
+/// @return 1: continue; 0: stop reading
+typedef int (*PuzzleTextHandler)(Puzzle *puzzle, void *context);
+
+/// @brief Called by streamPuzzleFile() for every 4x4, 16x16 or 25x25 puzzle read
+/// @details cells holds size * size values in row-major order, 0 == empty; it is reused after the call
+/// @return 1: continue; 0: stop reading
+typedef int (*SizedTextHandler)(int *cells, int size, void *context);
+
+/// @brief Called by streamPuzzleFile() for every rejected line, in order with the puzzles
+/// @details line is not terminated and is reused after the call; a line longer than #TEXT_BUFFER_SIZE
+/// \ is passed once, cut at #TEXT_BUFFER_SIZE bytes
+/// @return 1: continue; 0: stop reading
+typedef int (*RejectedTextHandler)(const char *line, size_t length, void *context);
+
+
+/// @brief Callbacks of streamPuzzleFile(), each can be NULL
+typedef struct PuzzleTextHandlers {
+    /// @brief Gets 9x9 puzzles
+    PuzzleTextHandler puzzle;
+    /// @brief Gets puzzles of other sizes; if NULL they are rejected
+    SizedTextHandler sized;
+    /// @brief Gets the lines counted as rejected in #TextImportStats
+    RejectedTextHandler rejected;
+} PuzzleTextHandlers;
+
+
+int parsePuzzleLine(const char *line, size_t length, Puzzle *puzzle);
+void formatPuzzleLine(const int grid[GRID_SIZE][GRID_SIZE], char *line);
+int parseSizedLine(const char *line, size_t length, int *cells);
+void formatSizedLine(const int *cells, int size, char *line);
+void streamPuzzleFile(FILE *file, const PuzzleTextHandlers *handlers, void *context, TextImportStats *stats);
+int streamPuzzleText(const char *filename, const PuzzleTextHandlers *handlers, void *context, TextImportStats *stats);
+int importPuzzleText(const char *filename, PuzzleArray *puzzleArray, int *puzzleCount, TextImportStats *stats);
+long exportPuzzleText(const char *filename, PuzzleArray puzzleArray, int puzzleCount, int userGrids);
+
+
+#endif
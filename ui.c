@@ -12,7 +12,12 @@
 #include "./dependencies.h"
 #include "./ui.h"
 #include "./puzzle.h"
+#include "./solver.h"
+#include "./batch.h"
+#include "./grade.h"
+#include "./canon.h"
 #include "./files.h"
+#include "./text.h"
 
 
 /// @brief English key-value dictionary for display strings
@@ -30,9 +35,15 @@ translation dictionaryEN[] = {
     {"MENU_MANAGER_OPTION_1", "1 : Reset everything*"},
     {"MENU_MANAGER_OPTION_2", "2 : Generate a new puzzle"},
     {"MENU_MANAGER_OPTION_3", "3 : Delete a puzzle"},
+    {"MENU_MANAGER_OPTION_4", "4 : Import puzzles from a text file"},
+    {"MENU_MANAGER_OPTION_5", "5 : Export puzzles to a text file"},
     {"MENU_MANAGER_OPTION_Q", "q : Back"},
     {"MENU_MANAGER_NOTE", "* Deletes solutions, resets to default puzzles"},
     {"MENU_MANAGER_RESET", "Puzzles reset successfully!"},
+    {"MENU_MANAGER_FILENAME", "Enter file name (one 81-character puzzle per line): "},
+    {"MENU_MANAGER_IMPORTED", "puzzles imported, lines rejected:"},
+    {"MENU_MANAGER_EXPORTED", "puzzles exported"},
+    {"MENU_MANAGER_FILEFAILED", "Unable to open or write file"},
 
     {"MENU_DELETE_LOADED", "puzzles have been loaded"},
     {"MENU_DELETE_OPTION_N", "n : Delete nth puzzle"},
@@ -49,26 +60,69 @@ translation dictionaryEN[] = {
 
     {"MENU_SOLVER_LOADED", "puzzles have been loaded"},
     {"MENU_SOLVER_OPTION_N", "n : Solve nth puzzle"},
+    {"MENU_SOLVER_OPTION_A", "a : Solve all puzzles"},
+    {"MENU_SOLVER_OPTION_E", "e : Change solver engine"},
+    {"MENU_SOLVER_OPTION_C", "c : Turn solution cache on/off"},
+    {"MENU_SOLVER_OPTION_P", "p : Keep solution cache between runs on/off"},
     {"MENU_SOLVER_OPTION_Q", "q : Back"},
     {"MENU_SOLVER_MISSING", "Puzzle does not exist"},
     {"MENU_SOLVER_SUCCESS", "Puzzle solved successfully!"},
+    {"MENU_SOLVER_ENGINE", "Solver engine:"},
+    {"MENU_SOLVER_BATCH", "puzzles solved using"},
+    {"MENU_SOLVER_THREADS", "threads"},
+    {"MENU_SOLVER_CACHE", "Solution cache:"},
+    {"MENU_SOLVER_CACHE_ON", "on"},
+    {"MENU_SOLVER_CACHE_OFF", "off"},
+    {"MENU_SOLVER_CACHE_HITS", "hits"},
+    {"MENU_SOLVER_CACHE_MISSES", "misses"},
+    {"MENU_SOLVER_CACHE_KEPT", "kept between runs"},
+
+    {"SOLVER_ENGINE_BACKTRACK", "Backtracking"},
+    {"SOLVER_ENGINE_PROPAGATE", "Constraint propagation"},
+    {"SOLVER_ENGINE_DLX", "Dancing Links"},
+    {"SOLVER_ENGINE_BITBOARD", "SIMD bitboard"},
+    {"SOLVER_ENGINE_ITERATIVE", "Iterative backtracking"},
+    {"SOLVER_ENGINE_PARALLEL", "Parallel propagation"},
+    {"SOLVER_ENGINE_UNKNOWN", "Unknown"},
 
     {"MENU_STATS_SOLVED", "Sudokus solved:"},
+    {"MENU_STATS_AVERAGECLUES", "Average clues per puzzle:"},
+    {"MENU_STATS_SOLVERSOLVED", "Puzzles solved by the algorithmic solver:"},
+    {"MENU_STATS_SOLVERTIME", "Average algorithmic solve time:"},
+    {"MENU_STATS_DIFFICULTY", "Puzzles of difficulty"},
     {"MENU_STATS_LAUNCHCOUNT", "Times this program was launched:"},
     {"MENU_STATS_RUNTIME", "CPU runtime this launch:"},
     {"MENU_STATS_TOTALRUNTIME", "Total CPU runtime:"},
+    {"MENU_STATS_SOLVERCALLS", "Solver calls this launch:"},
+    {"MENU_STATS_SOLVERNODES", "Search nodes / backtracks / propagated squares:"},
+    {"MENU_STATS_SOLVERDEPTH", "Deepest search path:"},
+    {"MENU_STATS_SOLVERPHASES", "Time loading / searching / storing:"},
+    {"MENU_STATS_INSTRUMENTATION_OFF", "Solver counters: off (build with -DSOLVER_INSTRUMENTATION)"},
+    {"MENU_STATS_OPTION_J", "j : Export solver counters as JSON"},
+    {"MENU_STATS_EXPORTED", "Solver counters exported"},
     {"MENU_STATS_OPTION_Q", "q : Exit statistics"},
 
     {"MENU_CHOOSEPUZZLE_OPTION_R", "r : Play random puzzle"},
     {"MENU_CHOOSEPUZZLE_OPTION_N", "n : Play nth puzzle"},
+    {"MENU_CHOOSEPUZZLE_OPTION_D", "e/m/h/x : Play random easy/medium/hard/expert puzzle"},
     {"MENU_CHOOSEPUZZLE_OPTION_Q", "q : Back"},
     {"MENU_CHOOSEPUZZLE_LOADED", "puzzles loaded"},
     {"MENU_CHOOSEPUZZLE_MISSING", "Puzzle does not exist"},
+    {"MENU_CHOOSEPUZZLE_NODIFFICULTY", "No puzzles of this difficulty"},
+
+    {"DIFFICULTY_UNGRADED", "Ungraded"},
+    {"DIFFICULTY_EASY", "Easy"},
+    {"DIFFICULTY_MEDIUM", "Medium"},
+    {"DIFFICULTY_HARD", "Hard"},
+    {"DIFFICULTY_EXPERT", "Expert"},
+    {"DIFFICULTY_INVALID", "Invalid (no unique solution)"},
 
     {"MENU_PLAY_OPTION_Q", "q : Back"},
     {"MENU_PLAY_OPTION_XY", "x y value : change value at (x,y)"},
     {"MENU_PLAY_OPTION_R", "r : Reset puzzle"},
     {"MENU_PLAY_SOLVED", "This puzzle has been solved"},
+    {"MENU_PLAY_DIFFICULTY", "Difficulty:"},
+    {"MENU_PLAY_CONFLICTS", "Conflicting values are shown in red"},
     {"MENU_PLAY_VALUEHIGHER", "Values cannot be higher than"},
     {"MENU_PLAY_VALUELOWER", "Values cannot be lower than"},
     {"MENU_PLAY_HINTVALUE", "Cannot change hint values!"},
@@ -77,13 +131,43 @@ translation dictionaryEN[] = {
     {"MENU_PLAY_SUCCESSFULLY", "successfully!"},
     {"MENU_PLAY_RESET", "Puzzle has been reset!"},
 
+    {"CLI_USAGE_1", "Usage: sudoku <command> [options] [files]"},
+    {"CLI_USAGE_2", "Commands: solve, validate, grade (read puzzles), generate (write puzzles)"},
+    {"CLI_USAGE_3", "Puzzles are 81-character lines, '.' or '0' empty; no files or - reads stdin"},
+    {"CLI_USAGE_4", "  -t n     worker threads (default: every core)"},
+    {"CLI_USAGE_5", "  -e name  engine: backtrack propagate dlx bitboard iterative parallel"},
+    {"CLI_USAGE_6", "  -n n     puzzles to generate (default: 1)"},
+    {"CLI_USAGE_7", "  -c n     clues of generated puzzles, 17-81 (default: 30)"},
+    {"CLI_USAGE_8", "  -s n     seed of generate, the same seed gives the same puzzles on any -t"},
+    {"CLI_USAGE_9", "  -j file  write solver counters as JSON (instrumented builds only)"},
+    {"CLI_USAGE_10", "  -T n     trace every nth search node to stderr (instrumented builds only)"},
+    {"CLI_USAGE_11", "  -m 1     generate minimal puzzles, -c is then the most clues allowed"},
+    {"CLI_USAGE_12", "  -k 1     reuse solutions of repeated and symmetric puzzles, in memory only"},
+    {"BENCH_USAGE_1", "Usage: bench [-n puzzles] [-s seed] [-e engine] [-c corpus] [-l seconds] [-k 1]"},
+    {"BENCH_USAGE_2", "  -n n     puzzles per corpus (default: 100)"},
+    {"BENCH_USAGE_3", "  -s n     corpus seed, the same seed builds the same puzzles (default: 1)"},
+    {"BENCH_USAGE_4", "  -e name  engine: backtrack propagate dlx bitboard iterative parallel"},
+    {"BENCH_USAGE_5", "  -c name  corpus: easy hard minimal17 adversarial"},
+    {"BENCH_USAGE_6", "  -l n     seconds per engine and corpus, the rest is skipped (default: 10)"},
+    {"BENCH_USAGE_7", "  -k 1     time solution cache misses, exact hits and symmetric hits instead"},
+    {"CLI_SUMMARY_PUZZLES", "puzzles"},
+    {"CLI_SUMMARY_SOLVED", "solved"},
+    {"CLI_SUMMARY_UNIQUE", "unique"},
+    {"CLI_SUMMARY_GRADED", "valid"},
+    {"CLI_SUMMARY_GENERATED", "generated"},
+    {"CLI_SUMMARY_REJECTED", "rejected lines"},
+    {"CLI_SUMMARY_RATE", "puzzles/s"},
+
     {"ERROR_RESET_DATA", "Unable to reset data"},
     {"ERROR_MEMORY_ALLOCATION", "Memory allocation failure"},
     {"ERROR_OPEN_FILE", "Failed to open file"},
     {"ERROR_WRITE_PUZZLECOUNT", "Failed to write puzzleCount to file"},
     {"ERROR_WRITE_PUZZLES", "Failed to write puzzles to file"},
     {"ERROR_READ_PUZZLECOUNT", "Failed to read puzzleCount from file"},
-    {"ERROR_READ_PUZZLES", "Failed to read puzzles from file"}
+    {"ERROR_SAVE_DAMAGED", "Save file is damaged, puzzles recovered:"},
+    {"ERROR_SAVE_BLOCK_DAMAGED", "Save file block is damaged, its puzzles are loaded empty, block:"},
+    {"ERROR_SAVE_JOURNAL_DISCARDED", "Unfinished save found and discarded, the last changes are lost"},
+    {"ERROR_WRITE_CACHE", "Failed to write solution cache to file"}
 };
 
 
@@ -147,7 +231,8 @@ void displayPuzzleGrid(Puzzle puzzle) {
 
 /// @brief Displays user grid of puzzle in CLI
 /// @param puzzle The puzzle to display
-void displayPuzzleUserGrid(Puzzle puzzle) {
+/// @note Squares conflicting with another square are shown in red, using the play tracker
+void displayPuzzleUserGrid(const Puzzle *puzzle) {
     for (int i = 0; i < GRID_SIZE; ++i) {
         if ((i % 3 == 0) && (i > 0)) {
             printf("|-----------------------|\n");
@@ -156,11 +241,14 @@ void displayPuzzleUserGrid(Puzzle puzzle) {
             if (j % 3 == 0) {
                 printf("| ");
             }
-            if (puzzle.map[i][j] == 1){
-                printf(ANSI_COLOR_MAGENTA "%d " ANSI_COLOR_RESET, puzzle.userGrid[i][j]); 
+            if (isSquareConflicting(puzzle, i, j)) {
+                printf(ANSI_COLOR_RED "%d " ANSI_COLOR_RESET, puzzle->userGrid[i][j]);
+            }
+            else if (puzzle->map[i][j] == 1){
+                printf(ANSI_COLOR_MAGENTA "%d " ANSI_COLOR_RESET, puzzle->userGrid[i][j]); 
             }
             else {
-                printf("%d ", puzzle.userGrid[i][j]); 
+                printf("%d ", puzzle->userGrid[i][j]); 
             }
               
         }
@@ -180,7 +268,7 @@ void menuPlay(Puzzle *puzzle) {
     int x, y, val;
     int firstLoop = 1;
     while (1) {
-        if (isSudokuSolved(*puzzle)) {
+        if (isPuzzleSolved(puzzle)) {
             printf(ANSI_COLOR_GREEN "%s\n" ANSI_COLOR_RESET,  translate("MENU_PLAY_SOLVED"));
             if (firstLoop == 1) {
                 printf("\n");
@@ -192,7 +280,11 @@ void menuPlay(Puzzle *puzzle) {
         }
         firstLoop = 0;
 
-        displayPuzzleUserGrid(*puzzle);
+        printf("%s %s\n", translate("MENU_PLAY_DIFFICULTY"), translate(difficultyKey(puzzle->difficulty)));
+        if (puzzle->tracker.conflicts > 0) {
+            printf(ANSI_COLOR_RED "%s\n" ANSI_COLOR_RESET, translate("MENU_PLAY_CONFLICTS"));
+        }
+        displayPuzzleUserGrid(puzzle);
         printf("%s\n", translate("MENU_PLAY_OPTION_Q"));
         printf("%s\n", translate("MENU_PLAY_OPTION_XY"));
         printf("%s\n\n", translate("MENU_PLAY_OPTION_R"));
@@ -250,6 +342,7 @@ void menuChoosePuzzle(PuzzleArray *puzzleArray, int puzzleCount) {
         printf("%d %s\n\n", puzzleCount, translate("MENU_CHOOSEPUZZLE_LOADED"));
         printf("%s\n", translate("MENU_CHOOSEPUZZLE_OPTION_R"));
         printf("%s\n", translate("MENU_CHOOSEPUZZLE_OPTION_N"));
+        printf("%s\n", translate("MENU_CHOOSEPUZZLE_OPTION_D"));
         printf("%s\n\n", translate("MENU_CHOOSEPUZZLE_OPTION_Q"));
         printf("%s", translate("MENU_SELECTION"));
 
@@ -257,7 +350,7 @@ void menuChoosePuzzle(PuzzleArray *puzzleArray, int puzzleCount) {
 
         if (sscanf(buffer, "%d", &selection) == 1) {
             if (selection > 0 && selection <= puzzleCount) {
-                menuPlay(&(*puzzleArray)[selection-1]);
+                menuPlay(gradedPuzzleAt(*puzzleArray, selection-1));
             }
             else {
                 clearDisplay();
@@ -266,7 +359,21 @@ void menuChoosePuzzle(PuzzleArray *puzzleArray, int puzzleCount) {
         }
         else if (sscanf(buffer, "%c", &selectionChar) == 1) {
             if (selectionChar == 'r') {
-                menuPlay(&(*puzzleArray)[rand()%puzzleCount]);
+                menuPlay(gradedPuzzleAt(*puzzleArray, rand()%puzzleCount));
+            }
+            else if (strchr("emhx", selectionChar) != NULL) {
+                Difficulty difficulty = selectionChar == 'e' ? DIFFICULTY_EASY : \
+                    selectionChar == 'm' ? DIFFICULTY_MEDIUM : \
+                    selectionChar == 'h' ? DIFFICULTY_HARD : DIFFICULTY_EXPERT;
+                ensurePuzzleIndexes(*puzzleArray, puzzleCount);
+                int index = randomPuzzleOfDifficulty(difficulty);
+                if (index >= 0) {
+                    menuPlay(gradedPuzzleAt(*puzzleArray, index));
+                }
+                else {
+                    clearDisplay();
+                    printf("%s\n\n", translate("MENU_CHOOSEPUZZLE_NODIFFICULTY"));
+                }
             }
             else if (selectionChar == 'q') {
                 clearDisplay();
@@ -344,8 +451,18 @@ void menuSolver(PuzzleArray *puzzleArrayPtr, int puzzleCount) {
     char selectionChar;
     while (1) { 
         displayBanner();
-        printf("%d %s\n\n", puzzleCount, translate("MENU_SOLVER_LOADED"));
+        printf("%d %s\n", puzzleCount, translate("MENU_SOLVER_LOADED"));
+        printf("%s %s\n", translate("MENU_SOLVER_ENGINE"), translate(solverEngineKey(solverEngine)));
+        printf("%s %s (%ld %s, %ld %s%s%s)\n\n", translate("MENU_SOLVER_CACHE"), \
+        translate(solutionCacheEnabled ? "MENU_SOLVER_CACHE_ON" : "MENU_SOLVER_CACHE_OFF"), \
+        solutionCacheStats.hits, translate("MENU_SOLVER_CACHE_HITS"), \
+        solutionCacheStats.misses, translate("MENU_SOLVER_CACHE_MISSES"), \
+        solutionCachePersistent ? ", " : "", solutionCachePersistent ? translate("MENU_SOLVER_CACHE_KEPT") : "");
         printf("%s\n", translate("MENU_SOLVER_OPTION_N"));
+        printf("%s\n", translate("MENU_SOLVER_OPTION_A"));
+        printf("%s\n", translate("MENU_SOLVER_OPTION_E"));
+        printf("%s\n", translate("MENU_SOLVER_OPTION_C"));
+        printf("%s\n", translate("MENU_SOLVER_OPTION_P"));
         printf("%s\n\n", translate("MENU_SOLVER_OPTION_Q"));
         printf("%s", translate("MENU_SELECTION"));
 
@@ -353,7 +470,7 @@ void menuSolver(PuzzleArray *puzzleArrayPtr, int puzzleCount) {
 
         if (sscanf(buffer, "%d", &selection) == 1) {
             if (selection > 0 && selection <= puzzleCount) {
-                solveSudokuUserGrid(&(*puzzleArrayPtr)[selection-1], 0, 0);
+                solveSudokuUserGrid(puzzleAt(*puzzleArrayPtr, selection-1), 0, 0);
                 clearDisplay();
                 printf(ANSI_COLOR_GREEN "%s\n\n" ANSI_COLOR_RESET, translate("MENU_SOLVER_SUCCESS"));
             }
@@ -363,7 +480,26 @@ void menuSolver(PuzzleArray *puzzleArrayPtr, int puzzleCount) {
             }
         }
         else if (sscanf(buffer, "%c", &selectionChar) == 1) {
-            if (selectionChar == 'q') {
+            if (selectionChar == 'a') {
+                int threadCount = findCoreCount();
+                int solvedCount = solvePuzzleBatch(*puzzleArrayPtr, puzzleCount, NULL, threadCount);
+                clearDisplay();
+                printf(ANSI_COLOR_GREEN "%d/%d %s %d %s\n\n" ANSI_COLOR_RESET, solvedCount, puzzleCount, \
+                translate("MENU_SOLVER_BATCH"), threadCount, translate("MENU_SOLVER_THREADS"));
+            }
+            else if (selectionChar == 'e') {
+                solverEngine = (solverEngine + 1) % SOLVER_ENGINE_COUNT;
+                clearDisplay();
+            }
+            else if (selectionChar == 'c') {
+                solutionCacheEnabled = !solutionCacheEnabled;
+                clearDisplay();
+            }
+            else if (selectionChar == 'p') {
+                setSolutionCachePersistent(!solutionCachePersistent);
+                clearDisplay();
+            }
+            else if (selectionChar == 'q') {
                 clearDisplay();
                 break;
             }
@@ -379,6 +515,33 @@ void menuSolver(PuzzleArray *puzzleArrayPtr, int puzzleCount) {
     }
 }
 
+/// @brief Asks for a file name
+/// @param buffer Buffer of #BUFFER_SIZE characters, receives the name without its newline
+static void readFileName(char *buffer) {
+    printf("%s", translate("MENU_MANAGER_FILENAME"));
+    if (fgets(buffer, BUFFER_SIZE, stdin) == NULL) {
+        buffer[0] = '\0';
+    }
+    buffer[strcspn(buffer, "\r\n")] = '\0';
+}
+
+/// @brief Prints the solver counters summed over this launch
+/// @details Launched by menuStats(), prints a single line if instrumentation is compiled out
+static void displaySolverStats() {
+    if (!solverInstrumentationEnabled()) {
+        printf("%s\n\n", translate("MENU_STATS_INSTRUMENTATION_OFF"));
+        return;
+    }
+    SolverStats stats;
+    readProcessSolverStats(&stats);
+    printf("%s %ld\n", translate("MENU_STATS_SOLVERCALLS"), stats.calls);
+    printf("%s %ld / %ld / %ld\n", translate("MENU_STATS_SOLVERNODES"), stats.nodes, stats.backtracks, \
+    stats.propagations);
+    printf("%s %d\n", translate("MENU_STATS_SOLVERDEPTH"), stats.maxDepth);
+    printf("%s %fs / %fs / %fs\n\n", translate("MENU_STATS_SOLVERPHASES"), stats.phaseSeconds[SOLVER_PHASE_LOAD], \
+    stats.phaseSeconds[SOLVER_PHASE_SEARCH], stats.phaseSeconds[SOLVER_PHASE_STORE]);
+}
+
 /// @brief Opens CLI to show statistics
 /// @param puzzleArray Array to show statistic from
 /// @param puzzleCount Array size
@@ -388,16 +551,28 @@ void menuStats(PuzzleArray *puzzleArray, int puzzleCount) {
     char buffer[BUFFER_SIZE];
     char selectionChar;
 
-    int solvedCount = countSolvedSudokus(puzzleCount, *puzzleArray);
+    ensurePuzzleIndexes(*puzzleArray, puzzleCount);
+    int solvedCount = puzzleIndex.solvedCount;
 
     while (1) { 
         displayBanner();
         
         printf("%s %d/%d (%d%%)\n", translate("MENU_STATS_SOLVED"), solvedCount, puzzleCount, \
-        (int)((double)solvedCount/puzzleCount * 100));
+        puzzleCount > 0 ? (int)((double)solvedCount/puzzleCount * 100) : 0);
+        printf("%s %.1f\n", translate("MENU_STATS_AVERAGECLUES"), \
+        puzzleIndex.puzzleCount > 0 ? (double)puzzleIndex.totalClues / puzzleIndex.puzzleCount : 0.0);
+        printf("%s %d\n", translate("MENU_STATS_SOLVERSOLVED"), puzzleIndex.timedCount);
+        printf("%s %fs\n", translate("MENU_STATS_SOLVERTIME"), \
+        puzzleIndex.timedCount > 0 ? puzzleIndex.totalSolveTime / puzzleIndex.timedCount : 0.0);
+        for (int d = DIFFICULTY_EASY; d <= DIFFICULTY_INVALID; ++d) {
+            printf("%s %s: %d\n", translate("MENU_STATS_DIFFICULTY"), translate(difficultyKey(d)), \
+            difficultyIndex.counts[d]);
+        }
         printf("%s %d\n", translate("MENU_STATS_LAUNCHCOUNT"), readLaunchCount());
         printf("%s %Lfs\n", translate("MENU_STATS_RUNTIME"), findCurrentRuntime());
         printf("%s %Lfs\n\n", translate("MENU_STATS_TOTALRUNTIME"), readTotalRuntime());
+        displaySolverStats();
+        printf("%s\n", translate("MENU_STATS_OPTION_J"));
         printf("%s\n\n", translate("MENU_STATS_OPTION_Q"));
         printf("%s", translate("MENU_SELECTION"));
 
@@ -405,6 +580,16 @@ void menuStats(PuzzleArray *puzzleArray, int puzzleCount) {
 
         if (sscanf(buffer, "%c", &selectionChar) == 1) {
             switch (selectionChar) {
+                case 'j':
+                    readFileName(buffer);
+                    clearDisplay();
+                    if (exportSolverStats(buffer)) {
+                        printf(ANSI_COLOR_GREEN "%s\n\n" ANSI_COLOR_RESET, translate("MENU_STATS_EXPORTED"));
+                    }
+                    else {
+                        printf("%s\n\n", translate("MENU_MANAGER_FILEFAILED"));
+                    }
+                    break;
                 case 'q':
                     clearDisplay();
                     return;
@@ -483,6 +668,8 @@ void menuManager(PuzzleArray *puzzleArrayPtr, int *puzzleCountPtr, PuzzleArray d
         printf("%s\n", translate("MENU_MANAGER_OPTION_1"));
         printf("%s\n", translate("MENU_MANAGER_OPTION_2"));
         printf("%s\n", translate("MENU_MANAGER_OPTION_3"));
+        printf("%s\n", translate("MENU_MANAGER_OPTION_4"));
+        printf("%s\n", translate("MENU_MANAGER_OPTION_5"));
         printf("%s\n\n", translate("MENU_MANAGER_OPTION_Q"));
         printf("%s\n\n", translate("MENU_MANAGER_NOTE"));
         printf("%s", translate("MENU_SELECTION"));
@@ -513,6 +700,31 @@ void menuManager(PuzzleArray *puzzleArrayPtr, int *puzzleCountPtr, PuzzleArray d
                     clearDisplay();
                     menuDelete(puzzleArrayPtr, puzzleCountPtr);
                     break;
+                case '4': {
+                    TextImportStats stats;
+                    readFileName(buffer);
+                    clearDisplay();
+                    if (importPuzzleText(buffer, puzzleArrayPtr, puzzleCountPtr, &stats)) {
+                        printf(ANSI_COLOR_GREEN "%ld %s %ld\n\n" ANSI_COLOR_RESET, stats.accepted, \
+                        translate("MENU_MANAGER_IMPORTED"), stats.rejected);
+                    }
+                    else {
+                        printf("%s\n\n", translate("MENU_MANAGER_FILEFAILED"));
+                    }
+                    break;
+                }
+                case '5': {
+                    readFileName(buffer);
+                    clearDisplay();
+                    long written = exportPuzzleText(buffer, *puzzleArrayPtr, *puzzleCountPtr, 0);
+                    if (written >= 0) {
+                        printf(ANSI_COLOR_GREEN "%ld %s\n\n" ANSI_COLOR_RESET, written, translate("MENU_MANAGER_EXPORTED"));
+                    }
+                    else {
+                        printf("%s\n\n", translate("MENU_MANAGER_FILEFAILED"));
+                    }
+                    break;
+                }
                 case 'q':
                     clearDisplay();
                     return;
@@ -30,7 +30,7 @@ char* translate(char* key);
 void clearDisplay();
 void displayBanner();
 void displayPuzzleGrid(Puzzle puzzle);
-void displayPuzzleUserGrid(Puzzle puzzle);
+void displayPuzzleUserGrid(const Puzzle *puzzle);
 
 
 void menuPlay(Puzzle *puzzle);
@@ -1,8 +1,52 @@
 #include <assert.h>
 
 #include "./puzzle.h"
+#include "./solver.h"
+#include "./kernels.h"
+#include "./batch.h"
+#include "./grade.h"
+#include "./canon.h"
+#include "./packed.h"
+#include "./lazy.h"
+#include "./text.h"
+#include "./files.h"
 #include "./dependencies.h"
 
+/// @brief Checks that every row, column and subgrid of a flat grid holds 1..size exactly once
+static int isValidSizedSolution(int *grid, int size, int box) {
+    for (int unit = 0; unit < size; ++unit) {
+        int rowSeen = 0, colSeen = 0, boxSeen = 0;
+        for (int k = 0; k < size; ++k) {
+            int boxRow = (unit / box) * box + k / box;
+            int boxCol = (unit % box) * box + k % box;
+            rowSeen |= 1 << grid[unit * size + k];
+            colSeen |= 1 << grid[k * size + unit];
+            boxSeen |= 1 << grid[boxRow * size + boxCol];
+        }
+        int all = ((1 << size) - 1) << 1;
+        if (rowSeen != all || colSeen != all || boxSeen != all) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// @brief Record source of the save file tests, encodes the puzzles of an array
+static void encodeTestRecord(int index, unsigned char *record, void *context) {
+    encodeSaveRecord(&((Puzzle *)context)[index], record);
+}
+
+/// @brief Opens a save file in lazy mode the way loadDataFromFile() does
+static int openTestStore(const char *filename) {
+    unsigned char header[SAVE_HEADER_SIZE];
+    FILE *file = fopen(filename, "rb");
+    int read = file != NULL && fread(header, SAVE_HEADER_SIZE, 1, file) == 1;
+    if (file != NULL) {
+        fclose(file);
+    }
+    return read && openLazyStore(filename, header);
+}
+
 int main() {
 
     Puzzle solved = {
@@ -48,6 +92,357 @@ int main() {
         }
     }
 
+    for (int engine = 0; engine < SOLVER_ENGINE_COUNT; ++engine) {
+        Puzzle copy = unsolved;
+        solverEngine = engine;
+        assert(solveSudokuUserGrid(&copy, 0, 0) == 1);
+        assert(memcmp(copy.userGrid, solved.userGrid, sizeof(copy.userGrid)) == 0);
+    }
+    solverEngine = SOLVER_ENGINE_BACKTRACK;
+
+    Puzzle recursive = {{}, {}};
+    Puzzle iterative = {{}, {}};
+    solveSudokuUserGrid(&recursive, 0, 0);
+    solverEngine = SOLVER_ENGINE_ITERATIVE;
+    solveSudokuUserGrid(&iterative, 0, 0);
+    solverEngine = SOLVER_ENGINE_BACKTRACK;
+    assert(memcmp(recursive.userGrid, iterative.userGrid, sizeof(recursive.userGrid)) == 0);
+
+    Puzzle counted = unsolved;
+    assert(solveSudokuUncached(&counted, 0, 0) == 1);
+    assert((solverStats.nodes > 0) == solverInstrumentationEnabled());
+    assert(solverStats.nodes - solverStats.backtracks == solverStats.maxDepth);
+    assert(findSolverEngine(solverEngineName(SOLVER_ENGINE_DLX)) == SOLVER_ENGINE_DLX);
+
+    Puzzle empty = {{}, {}};
+    Puzzle conflicting = solved;
+    conflicting.userGrid[0][0] = conflicting.userGrid[0][1];
+    Puzzle before = unsolved;
+    assert(countSolutions(&unsolved, 2) == 1);
+    assert(memcmp(&before, &unsolved, sizeof(Puzzle)) == 0);
+    assert(countSolutions(&empty, 5) == 5);
+    assert(countSolutions(&conflicting, 2) == 0);
+    assert(hasUniqueSolution(&solved) == 1);
+
+    Puzzle batch[8];
+    BatchStatus statuses[8];
+    for (int i = 0; i < 8; ++i) {
+        batch[i] = (i == 5) ? conflicting : unsolved;
+    }
+    solverEngine = SOLVER_ENGINE_PROPAGATE;
+    assert(solvePuzzleBatch(batch, 8, statuses, 4) == 7);
+    solverEngine = SOLVER_ENGINE_BACKTRACK;
+    for (int i = 0; i < 8; ++i) {
+        assert(statuses[i] == ((i == 5) ? BATCH_STATUS_UNSOLVABLE : BATCH_STATUS_SOLVED));
+    }
+    assert(memcmp(batch[0].userGrid, solved.userGrid, sizeof(solved.userGrid)) == 0);
+
+    int sizes[] = {4, 9, 16, 25};
+    for (int s = 0; s < 4; ++s) {
+        int size = sizes[s];
+        int box = (size == 4) ? 2 : (size == 9) ? 3 : (size == 16) ? 4 : 5;
+        int grid[MAX_KERNEL_SIZE * MAX_KERNEL_SIZE];
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                grid[i * size + j] = ((i * size + j) % 3 == 0) ? 0 : (i * box + i / box + j) % size + 1;
+            }
+        }
+        assert(countSizedSolutions(grid, size, 2) >= 1);
+        char sizedLine[TEXT_MAX_SQUARES + 1];
+        int parsedCells[TEXT_MAX_SQUARES];
+        formatSizedLine(grid, size, sizedLine);
+        assert(size == 9 || parseSizedLine(sizedLine, size * size, parsedCells) == size);
+        assert(size == 9 || memcmp(parsedCells, grid, size * size * sizeof(int)) == 0);
+        assert(solveSizedGrid(grid, size) == 1);
+        assert(isValidSizedSolution(grid, size, box));
+    }
+    int badCells[16];
+    assert(parseSizedLine("1234341221434321", 15, badCells) == 0 && parseSizedLine("12343412214343G1", 16, badCells) == 0);
+    assert(solveSizedGrid(NULL, 5) == -1);
+
+    int rating;
+    assert(gradeGrid(unsolved.userGrid, &rating) == DIFFICULTY_EASY && rating > 0);
+    assert(gradeGrid(empty.userGrid, &rating) == DIFFICULTY_INVALID);
+    assert(gradeGrid(conflicting.userGrid, &rating) == DIFFICULTY_INVALID);
+    addToDifficultyIndex(3, DIFFICULTY_EASY);
+    assert(randomPuzzleOfDifficulty(DIFFICULTY_EASY) == 3);
+    assert(randomPuzzleOfDifficulty(DIFFICULTY_HARD) == -1);
+
+    GridTransform shuffle = {1, {4, 3, 5, 1, 0, 2, 8, 6, 7}, {6, 7, 8, 0, 2, 1, 3, 4, 5}, {0, 2, 3, 4, 5, 6, 7, 8, 9, 1}};
+    Puzzle shuffled = {{}, {}};
+    Puzzle shuffledSolution = {{}, {}};
+    applyTransform(&shuffle, unsolved.userGrid, shuffled.userGrid);
+    applyTransform(&shuffle, solved.userGrid, shuffledSolution.userGrid);
+    int canonical[9][9], shuffledCanonical[9][9];
+    GridTransform transform;
+    assert(canonicalizeGrid(unsolved.userGrid, canonical, &transform) == 1);
+    assert(canonicalizeGrid(shuffled.userGrid, shuffledCanonical, &transform) == 1);
+    assert(memcmp(canonical, shuffledCanonical, sizeof(canonical)) == 0);
+
+    Puzzle cached = unsolved;
+    clearSolutionCache();
+    solutionCacheEnabled = 1;
+    assert(solveSudokuUserGrid(&cached, 0, 0) == 1);
+    assert(solveSudokuUserGrid(&shuffled, 0, 0) == 1);
+    assert(solutionCacheStats.hits == 1 && solutionCacheStats.misses == 1);
+    assert(memcmp(shuffled.userGrid, shuffledSolution.userGrid, sizeof(shuffled.userGrid)) == 0);
+    cached = unsolved;
+    assert(solveSudokuUserGrid(&cached, 0, 0) == 1);
+    assert(solutionCacheStats.hits == 2 && solutionCacheStats.misses == 1);
+    assert(memcmp(cached.userGrid, solved.userGrid, sizeof(cached.userGrid)) == 0);
+    solutionCacheEnabled = 0;
+
+    Puzzle play = {{}, {}, {}};
+    memcpy(play.grid, unsolved.userGrid, sizeof(play.grid));
+    generateBitmap(&play);
+    generateUserGrid(&play);
+    assert(isPuzzleSolved(&play) == 0 && play.tracker.conflicts == 0);
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            if (play.map[i][j] == 0) {
+                assert(changeValue(&play, j + 1, 9 - i, solved.userGrid[i][j]) == 0);
+            }
+        }
+    }
+    assert(isPuzzleSolved(&play) == 1 && isSudokuSolved(play) == 1);
+    changeValue(&play, 3, 9, 1);
+    assert(isPuzzleSolved(&play) == 0 && isSquareConflicting(&play, 0, 2) && isSquareConflicting(&play, 0, 1));
+    changeValue(&play, 3, 9, 0);
+    assert(play.tracker.conflicts == 0 && play.tracker.filled == 80);
+    changeValue(&play, 3, 9, solved.userGrid[0][2]);
+    assert(isPuzzleSolved(&play) == 1);
+
+    PuzzleArray collection = NULL;
+    int collectionCount = 0;
+    Puzzle clues = {{}, {}, {}};
+    memcpy(clues.grid, unsolved.userGrid, sizeof(clues.grid));
+    addPuzzle(&clues, &collection, &collectionCount);
+    addPuzzle(&clues, &collection, &collectionCount);
+    assert(puzzleIndex.puzzleCount == 2 && puzzleIndex.solvedCount == 0);
+    assert(puzzleIndex.clueCounts[collection[0].meta.clueCount] == 2);
+    assert(solveSudokuUserGrid(&collection[1], 0, 0) == 1);
+    assert(puzzleIndex.solvedCount == 1 && collection[1].meta.solved == 1);
+    changeValue(&collection[1], 3, 9, 0);
+    assert(puzzleIndex.solvedCount == 0 && collection[1].meta.lastModified != 0);
+    changeValue(&collection[1], 3, 9, solved.userGrid[0][2]);
+    deleteNthPuzzle(&collection, &collectionCount, 0);
+    assert(puzzleIndex.puzzleCount == 1 && puzzleIndex.solvedCount == 1);
+    assert(countSolvedSudokus(collectionCount, collection) == puzzleIndex.solvedCount);
+    assert(lazyStoreActive() == 0 && puzzleAt(collection, 0) == &collection[0]);
+    assert(collection[0].meta.handle == 1 && findPuzzleHandle(collection, 1) == 0);
+    assert(findPuzzleHandle(collection, 0) == -1 && findPuzzleHandle(collection, 2) == -1);
+    reservePuzzles(&collection, collectionCount, 100);
+    assert(puzzleArrayCapacity(collection) >= 101 && findPuzzleHandle(collection, 1) == 0);
+    for (int k = 0; k < 40; ++k) {
+        addPuzzle(&clues, &collection, &collectionCount);
+    }
+    int handle = collection[10].meta.handle;
+    deleteNthPuzzle(&collection, &collectionCount, 3);
+    assert(collectionCount == 40 && collection[3].meta.handle == 41);
+    assert(findPuzzleHandle(collection, 41) == 3 && findPuzzleHandle(collection, handle) == 10);
+    assert(puzzleIndex.puzzleCount == collectionCount);
+    assert(collection[0].difficulty == DIFFICULTY_UNGRADED && difficultyIndex.counts[DIFFICULTY_UNGRADED] == 40);
+    ensurePuzzleIndexes(collection, collectionCount);
+    assert(difficultyIndex.counts[DIFFICULTY_UNGRADED] == 0 && collection[39].difficulty == DIFFICULTY_EASY);
+    int timedCount = puzzleIndex.timedCount;
+    assert(solvePuzzleBatch(collection + 1, 3, NULL, 2) == 3);
+    assert(puzzleIndex.timedCount == timedCount + 3 && collection[2].meta.solveTime >= 0);
+    freePuzzleArray(collection);
+
+    const char *saveName = "unit_tests_save.bin";
+    PuzzleArray saveSource = NULL, saveLoaded = NULL;
+    int saveSourceCount = 0, saveLoadedCount = 0, legacy = 0;
+    for (int k = 0; k < SAVE_BLOCK_RECORDS + 10; ++k) {
+        addPuzzle(k % 2 ? &clues : &play, &saveSource, &saveSourceCount);
+    }
+    writeSaveFile(saveName, saveSourceCount, encodeTestRecord, saveSource);
+    assert(fopen("unit_tests_save.bin" SAVE_TEMP_SUFFIX, "rb") == NULL);
+    assert(readSaveFile(saveName, &saveLoaded, &saveLoadedCount, &legacy) == 1 && legacy == 0);
+    assert(saveLoadedCount == saveSourceCount);
+    for (int k = 0; k < saveSourceCount; k += SAVE_BLOCK_RECORDS / 2 + 1) {
+        assert(memcmp(saveLoaded[k].userGrid, saveSource[k].userGrid, sizeof(saveSource[k].userGrid)) == 0);
+        assert(memcmp(saveLoaded[k].map, saveSource[k].map, sizeof(saveSource[k].map)) == 0);
+        assert(saveLoaded[k].meta.handle == 0 && saveLoaded[k].difficulty == saveSource[k].difficulty);
+    }
+    freePuzzleArray(saveLoaded);
+
+    FILE *saveFile = fopen(saveName, "rb");
+    fseek(saveFile, 0, SEEK_END);
+    long saveSize = ftell(saveFile);
+    unsigned char *saveBytes = malloc(saveSize);
+    rewind(saveFile);
+    assert(fread(saveBytes, saveSize, 1, saveFile) == 1);
+    fclose(saveFile);
+    long secondBlock = SAVE_HEADER_SIZE + SAVE_BLOCK_RECORDS * (long)SAVE_RECORD_SIZE + 4;
+    saveBytes[secondBlock + 5] ^= 0x10;
+    saveFile = fopen(saveName, "wb");
+    fwrite(saveBytes, saveSize, 1, saveFile);
+    fclose(saveFile);
+    assert(readSaveFile(saveName, &saveLoaded, &saveLoadedCount, NULL) == 0 && saveLoadedCount == SAVE_BLOCK_RECORDS);
+    freePuzzleArray(saveLoaded);
+    saveBytes[secondBlock + 5] ^= 0x10;
+    saveFile = fopen(saveName, "wb");
+    fwrite(saveBytes, secondBlock + 7 * SAVE_RECORD_SIZE, 1, saveFile);
+    fclose(saveFile);
+    assert(readSaveFile(saveName, &saveLoaded, &saveLoadedCount, NULL) == 0 && saveLoadedCount == SAVE_BLOCK_RECORDS);
+    freePuzzleArray(saveLoaded);
+    free(saveBytes);
+
+    for (int legacyCount = 2; legacyCount <= 3; ++legacyCount) {
+        saveFile = fopen(saveName, "wb");
+        fwrite(&legacyCount, sizeof(legacyCount), 1, saveFile);
+        for (int k = 0; k < 2; ++k) {
+            fwrite(saveSource[k].grid, sizeof(saveSource[k].grid), 1, saveFile);
+            fwrite(saveSource[k].userGrid, sizeof(saveSource[k].userGrid), 1, saveFile);
+            int legacyMap[GRID_SIZE][GRID_SIZE];
+            for (int cell = 0; cell < CELL_COUNT; ++cell) {
+                legacyMap[cell / GRID_SIZE][cell % GRID_SIZE] = saveSource[k].map[cell / GRID_SIZE][cell % GRID_SIZE];
+            }
+            fwrite(legacyMap, sizeof(legacyMap), 1, saveFile);
+        }
+        fwrite(saveSource[2].grid, sizeof(saveSource[2].grid), legacyCount - 2, saveFile);
+        fclose(saveFile);
+        assert(readSaveFile(saveName, &saveLoaded, &saveLoadedCount, &legacy) == (legacyCount == 2));
+        assert(legacy == 1 && saveLoadedCount == 2);
+        assert(memcmp(saveLoaded[1].grid, clues.grid, sizeof(clues.grid)) == 0);
+        assert(memcmp(saveLoaded[0].grid, saveSource[0].grid, sizeof(saveSource[0].grid)) == 0);
+        freePuzzleArray(saveLoaded);
+    }
+    freePuzzleArray(saveSource);
+    remove(saveName);
+
+    const char *lazyName = "unit_tests_lazy.bin";
+    const char *lazyJournal = "unit_tests_lazy.bin" LAZY_JOURNAL_SUFFIX;
+    PuzzleArray lazySource = NULL;
+    int lazySourceCount = 0;
+    for (int k = 0; k < SAVE_BLOCK_RECORDS + 10; ++k) {
+        addPuzzle(&clues, &lazySource, &lazySourceCount);
+    }
+    writeSaveFile(lazyName, lazySourceCount, encodeTestRecord, lazySource);
+    freePuzzleArray(lazySource);
+    assert(openTestStore(lazyName) == 1 && lazyStoreActive() == 1 && lazyPuzzleCount() == lazySourceCount);
+    Puzzle *lazyPuzzle = puzzleAt(NULL, SAVE_BLOCK_RECORDS + 3);
+    assert(memcmp(lazyPuzzle->grid, clues.grid, sizeof(clues.grid)) == 0 && lazyPuzzle->map[0][0] == 1);
+    assert(changeValue(lazyPuzzle, 3, 9, solved.userGrid[0][2]) == 0);
+    flushLazyStore(lazyName);
+    assert(fopen(lazyJournal, "rb") == NULL && replaySaveJournal(lazyName) == 0);
+    FILE *tornJournal = fopen(lazyJournal, "wb");
+    fwrite(LAZY_JOURNAL_MAGIC "torn", 8, 1, tornJournal);
+    fclose(tornJournal);
+    assert(replaySaveJournal(lazyName) == 0 && fopen(lazyJournal, "rb") == NULL);
+    closeLazyStore();
+    assert(openTestStore(lazyName) == 1);
+    assert(puzzleAt(NULL, SAVE_BLOCK_RECORDS + 3)->userGrid[0][2] == solved.userGrid[0][2]);
+    assert(puzzleAt(NULL, 1)->userGrid[0][2] == 0);
+
+    PuzzleArray lazyArray = NULL;
+    int lazyCount = lazyPuzzleCount();
+    invalidatePuzzleIndexes();
+    ensurePuzzleIndexes(lazyArray, lazyCount);
+    assert(puzzleIndex.puzzleCount == lazyCount && difficultyIndex.counts[DIFFICULTY_EASY] == lazyCount);
+    deleteNthPuzzle(&lazyArray, &lazyCount, SAVE_BLOCK_RECORDS + 3);
+    deleteNthPuzzle(&lazyArray, &lazyCount, 0);
+    assert(lazyCount == lazySourceCount - 2 && lazyPuzzleCount() == lazyCount);
+    assert(puzzleIndex.puzzleCount == lazyCount && difficultyIndex.counts[DIFFICULTY_EASY] == lazyCount);
+    assert(puzzleIndex.solvedCount == 0 && puzzleAt(NULL, SAVE_BLOCK_RECORDS + 3)->userGrid[0][2] == 0);
+    flushLazyStore(lazyName);
+    closeLazyStore();
+    assert(openTestStore(lazyName) == 1 && lazyPuzzleCount() == lazyCount);
+    closeLazyStore();
+    remove(lazyName);
+
+    PackedPuzzle packed;
+    Puzzle unpacked = {{}, {}, {}};
+    assert(sizeof(PackedPuzzle) == 93);
+    packPuzzle(&play, &packed);
+    unpackPuzzle(&packed, &unpacked);
+    assert(memcmp(unpacked.grid, play.grid, sizeof(play.grid)) == 0);
+    assert(memcmp(unpacked.userGrid, play.userGrid, sizeof(play.userGrid)) == 0);
+    assert(memcmp(unpacked.map, play.map, sizeof(play.map)) == 0);
+    assert(isPackedSolved(&packed) == 1);
+    packPuzzle(&unsolved, &packed);
+    assert(isPackedSolved(&packed) == 0);
+    assert(solvePackedPuzzle(&packed) == 1 && isPackedSolved(&packed) == 1);
+    unpackPuzzle(&packed, &unpacked);
+    assert(memcmp(unpacked.userGrid, solved.userGrid, sizeof(solved.userGrid)) == 0);
+    packPuzzle(&play, &packed);
+    assert(changePackedValue(&packed, 0, 0, 5) == -1 && changePackedValue(&packed, 0, 2, 0) == 0);
+    assert(packedCell(packed.userGrid, 2) == 0 && packedCell(packed.userGrid, 1) == 1);
+
+    char line[CELL_COUNT + 8];
+    Puzzle parsed = {{}, {}, {}};
+    formatPuzzleLine(unsolved.userGrid, line);
+    assert(line[0] != '0' && (line[2] == '.' || unsolved.userGrid[0][2] != 0));
+    assert(parsePuzzleLine(line, CELL_COUNT, &parsed) == 1);
+    assert(memcmp(parsed.grid, unsolved.userGrid, sizeof(parsed.grid)) == 0);
+    memcpy(line + CELL_COUNT, ",x", 2);
+    assert(parsePuzzleLine(line, CELL_COUNT + 2, &parsed) == 1);
+    line[40] = 'x';
+    assert(parsePuzzleLine(line, CELL_COUNT, &parsed) == 0 && parsePuzzleLine(line, 80, &parsed) == 0);
+    Puzzle outOfRange = unsolved;
+    outOfRange.userGrid[0][1] = 15;
+    outOfRange.userGrid[4][4] = -3;
+    outOfRange.userGrid[8][8] = 10;
+    formatPuzzleLine(outOfRange.userGrid, line);
+    assert(line[1] == '.' && line[40] == '.' && line[80] == '.');
+    assert(parsePuzzleLine(line, CELL_COUNT, &parsed) == 1);
+
+    Puzzle generated = {{}, {}};
+    srand(7);
+    assert(generateUniquePuzzle(&generated, 28, 0, NULL) == 28 && hasUniqueSolution(&generated) == 1);
+    int minimalClues = generateUniquePuzzle(&generated, 81, 1, NULL);
+    assert(minimalClues >= 17 && hasUniqueSolution(&generated) == 1);
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        int value = generated.userGrid[cell / GRID_SIZE][cell % GRID_SIZE];
+        if (value != 0) {
+            generated.userGrid[cell / GRID_SIZE][cell % GRID_SIZE] = 0;
+            assert(countSolutions(&generated, 2) == 2);
+            generated.userGrid[cell / GRID_SIZE][cell % GRID_SIZE] = value;
+        }
+    }
+    PropagationState cleared, reloaded;
+    assert(loadPropagationState(&cleared, generated.userGrid) == 1);
+    int clue = 0;
+    while (generated.userGrid[clue / GRID_SIZE][clue % GRID_SIZE] == 0) {
+        ++clue;
+    }
+    clearDigit(&cleared, clue);
+    generated.userGrid[clue / GRID_SIZE][clue % GRID_SIZE] = 0;
+    assert(loadPropagationState(&reloaded, generated.userGrid) == 1 && cleared.emptyCount == reloaded.emptyCount);
+    assert(memcmp(cleared.cells, reloaded.cells, sizeof(cleared.cells)) == 0);
+    assert(memcmp(cleared.candidates, reloaded.candidates, sizeof(cleared.candidates)) == 0);
+
+    int solution[GRID_SIZE][GRID_SIZE];
+    drawSolutionGrid(solution, NULL);
+    memcpy(generated.userGrid, solution, sizeof(solution));
+    assert(isSudokuSolved(generated) == 1);
+    GridTransform drawn;
+    randomGridTransform(&drawn, NULL);
+    applyTransform(&drawn, solution, generated.userGrid);
+    assert(isSudokuSolved(generated) == 1);
+
+    RandomStream streamA, streamB;
+    seedRandomStream(&streamA, 42, 3);
+    seedRandomStream(&streamB, 42, 3);
+    assert(nextRandom(&streamA) == nextRandom(&streamB));
+    seedRandomStream(&streamB, 42, 4);
+    assert(nextRandom(&streamA) != nextRandom(&streamB) && randomBelow(&streamA, 9) < 9);
+    Puzzle singleThread[6], multiThread[6];
+    assert(generatePuzzleBatch(singleThread, 6, 30, 0, 42, 0, 1) == 6);
+    assert(generatePuzzleBatch(multiThread, 6, 30, 0, 42, 0, 4) == 6);
+    assert(memcmp(singleThread, multiThread, sizeof(singleThread)) == 0);
+    assert(generatePuzzleBatch(multiThread, 3, 30, 0, 42, 3, 2) == 3);
+    assert(memcmp(singleThread + 3, multiThread, 3 * sizeof(Puzzle)) == 0);
+
+    UsageCounters counters = {123456789012ULL, 4321.5, 1700000000LL, 1710000000LL}, decoded;
+    unsigned char counterBytes[STATS_FILE_SIZE];
+    encodeUsageCounters(&counters, counterBytes);
+    assert(decodeUsageCounters(counterBytes, &decoded) == 1);
+    assert(decoded.launchCount == counters.launchCount && decoded.totalRuntime == counters.totalRuntime);
+    assert(decoded.firstLaunch == counters.firstLaunch && decoded.lastLaunch == counters.lastLaunch);
+    counterBytes[10] ^= 1;
+    assert(decodeUsageCounters(counterBytes, &decoded) == 0);
+
     solveSudokuUserGrid(&unsolved, 0 , 0);
 
     for (int i = 0; i < 9; ++i) {